@@ -0,0 +1,365 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AtomicFileWriter.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/Event.h"
+#include "HAL/IConsoleManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/FileHelper.h"
+#include "Async/ParallelFor.h"
+#include <atomic>
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+#elif PLATFORM_UNIX || PLATFORM_MAC
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+namespace AtomicFileWriter
+{
+	/** One finished and flushed temp file waiting for its rename */
+	struct FCommitRequest
+	{
+		FString TempPath;
+		FString FilePath;
+		FString ErrorMessage;
+		bool bSucceeded = false;
+		// Set by the previous leader when this request should commit the next batch
+		bool bLeader = false;
+		FEvent* Done = nullptr;
+	};
+
+	/**
+	 * Rename queue. The first writer to arrive renames everything queued at that point
+	 * and syncs the directory; writers arriving meanwhile queue up and the first of them
+	 * commits the next batch, so a batch grows with the time the previous directory sync took.
+	 */
+	struct FCommitQueue
+	{
+		FCriticalSection Lock;
+		TArray<FCommitRequest*> Pending;
+		bool bCommitInProgress = false;
+
+		static FCommitQueue& Get()
+		{
+			static FCommitQueue Queue;
+			return Queue;
+		}
+	};
+
+	static std::atomic<int64> NumFilesCommitted{0};
+	static std::atomic<int64> NumFileSyncs{0};
+	static std::atomic<int64> NumBatches{0};
+	static std::atomic<int64> NumDirectorySyncs{0};
+
+	/** Make the directory entries (the renames) durable */
+	static bool SyncDirectory(const FString& Directory)
+	{
+#if PLATFORM_UNIX || PLATFORM_MAC
+		const int Fd = open(TCHAR_TO_UTF8(*Directory), O_RDONLY);
+		if (Fd < 0)
+		{
+			return false;
+		}
+		const bool bSynced = fsync(Fd) == 0;
+		close(Fd);
+		return bSynced;
+#else
+		// Windows has no directory handle to sync; MOVEFILE_WRITE_THROUGH already made the rename durable
+		return true;
+#endif
+	}
+
+	/** Rename TempPath over FilePath in one step, replacing any existing file */
+	static bool ReplaceFile(const FString& TempPath, const FString& FilePath)
+	{
+#if PLATFORM_WINDOWS
+		return MoveFileExW(*TempPath, *FilePath, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#elif PLATFORM_UNIX || PLATFORM_MAC
+		return rename(TCHAR_TO_UTF8(*TempPath), TCHAR_TO_UTF8(*FilePath)) == 0;
+#else
+		// No atomic replace available; fall back to delete and move
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		PlatformFile.DeleteFile(*FilePath);
+		return PlatformFile.MoveFile(*FilePath, *TempPath);
+#endif
+	}
+
+	static void CommitBatch(const TArray<FCommitRequest*>& Batch)
+	{
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+		TMap<FString, TArray<FCommitRequest*>> ByDirectory;
+		for (FCommitRequest* Request : Batch)
+		{
+			ByDirectory.FindOrAdd(FPaths::GetPath(Request->FilePath)).Add(Request);
+		}
+
+		for (const TPair<FString, TArray<FCommitRequest*>>& Group : ByDirectory)
+		{
+			// File data was flushed by each writer before it queued, so only the renames are left
+			bool bAnyRenamed = false;
+			for (FCommitRequest* Request : Group.Value)
+			{
+				Request->bSucceeded = ReplaceFile(Request->TempPath, Request->FilePath);
+				if (Request->bSucceeded)
+				{
+					bAnyRenamed = true;
+					++NumFilesCommitted;
+				}
+				else
+				{
+					Request->ErrorMessage = FString::Printf(TEXT("Failed to rename %s to %s"), *Request->TempPath, *Request->FilePath);
+					PlatformFile.DeleteFile(*Request->TempPath);
+				}
+			}
+
+			// One directory sync covers every rename in the batch
+			if (bAnyRenamed)
+			{
+				++NumDirectorySyncs;
+				if (!SyncDirectory(Group.Key))
+				{
+					// The renames are still atomic; a crash now can only bring back the previous files
+					UE_LOG(LogTemp, Warning, TEXT("Failed to sync directory: %s"), *Group.Key);
+				}
+			}
+		}
+	}
+
+	static void Commit(FCommitRequest& Request)
+	{
+		FCommitQueue& Queue = FCommitQueue::Get();
+		Request.Done = FPlatformProcess::GetSynchEventFromPool();
+
+		// bLeader may be set by the current leader as soon as the lock is released,
+		// so a follower only reads it again after being woken
+		bool bLeader = false;
+		{
+			FScopeLock Lock(&Queue.Lock);
+			Queue.Pending.Add(&Request);
+			bLeader = !Queue.bCommitInProgress;
+			Queue.bCommitInProgress = true;
+		}
+
+		// Woken either with the batch committed or to commit the next one
+		if (!bLeader)
+		{
+			Request.Done->Wait();
+			bLeader = Request.bLeader;
+		}
+
+		if (bLeader)
+		{
+			TArray<FCommitRequest*> Batch;
+			{
+				FScopeLock Lock(&Queue.Lock);
+				Batch = MoveTemp(Queue.Pending);
+				Queue.Pending.Reset();
+			}
+
+			CommitBatch(Batch);
+			++NumBatches;
+
+			FCommitRequest* NextLeader = nullptr;
+			{
+				FScopeLock Lock(&Queue.Lock);
+				if (Queue.Pending.Num() > 0)
+				{
+					NextLeader = Queue.Pending[0];
+					NextLeader->bLeader = true;
+				}
+				else
+				{
+					Queue.bCommitInProgress = false;
+				}
+			}
+
+			// Waiting requests may go out of scope as soon as they are triggered
+			for (FCommitRequest* Committed : Batch)
+			{
+				if (Committed != &Request)
+				{
+					Committed->Done->Trigger();
+				}
+			}
+			if (NextLeader)
+			{
+				NextLeader->Done->Trigger();
+			}
+		}
+
+		FPlatformProcess::ReturnSynchEventToPool(Request.Done);
+		Request.Done = nullptr;
+	}
+
+	static bool SaveBytes(const uint8* Data, int64 NumBytes, const FString& FilePath, FString& OutErrorMessage)
+	{
+		FString TempPath;
+		IFileHandle* Handle = FAtomicFileWriter::OpenStream(FilePath, TempPath, OutErrorMessage);
+		if (!Handle)
+		{
+			return false;
+		}
+
+		if (!Handle->Write(Data, NumBytes))
+		{
+			FAtomicFileWriter::DiscardStream(Handle, TempPath);
+			OutErrorMessage = FString::Printf(TEXT("Failed to write temporary file: %s"), *TempPath);
+			return false;
+		}
+
+		return FAtomicFileWriter::CommitStream(Handle, TempPath, FilePath, OutErrorMessage);
+	}
+}
+
+bool FAtomicFileWriter::SaveArrayToFile(const TArray<uint8>& Bytes, const FString& FilePath, FString& OutErrorMessage)
+{
+	return AtomicFileWriter::SaveBytes(Bytes.GetData(), Bytes.Num(), FilePath, OutErrorMessage);
+}
+
+bool FAtomicFileWriter::SaveStringToFile(const FString& Text, const FString& FilePath, FString& OutErrorMessage)
+{
+	FTCHARToUTF8 TextUTF8(*Text);
+	return AtomicFileWriter::SaveBytes((const uint8*)TextUTF8.Get(), TextUTF8.Length(), FilePath, OutErrorMessage);
+}
+
+IFileHandle* FAtomicFileWriter::OpenStream(const FString& FilePath, FString& OutTempPath, FString& OutErrorMessage)
+{
+	// The temp file sits next to the destination so the rename never crosses file systems
+	OutTempPath = FString::Printf(TEXT("%s.%s.tmp"), *FPaths::ConvertRelativePathToFull(FilePath), *FGuid::NewGuid().ToString());
+
+	IFileHandle* Handle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*OutTempPath);
+	if (!Handle)
+	{
+		OutErrorMessage = FString::Printf(TEXT("Failed to create temporary file: %s"), *OutTempPath);
+	}
+	return Handle;
+}
+
+bool FAtomicFileWriter::CommitStream(IFileHandle* Handle, const FString& TempPath, const FString& FilePath, FString& OutErrorMessage)
+{
+	// File data must be on disk before the rename, or a crash can leave the new name pointing at an empty file.
+	// Each writer flushes its own file here, in parallel with the others; the batch only renames.
+	const bool bFlushed = Handle->Flush(true);
+	delete Handle;
+	++AtomicFileWriter::NumFileSyncs;
+	if (!bFlushed)
+	{
+		FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*TempPath);
+		OutErrorMessage = FString::Printf(TEXT("Failed to flush file: %s"), *TempPath);
+		return false;
+	}
+
+	AtomicFileWriter::FCommitRequest Request;
+	Request.FilePath = FPaths::ConvertRelativePathToFull(FilePath);
+	Request.TempPath = TempPath;
+
+	AtomicFileWriter::Commit(Request);
+
+	if (!Request.bSucceeded)
+	{
+		OutErrorMessage = Request.ErrorMessage;
+		return false;
+	}
+
+	return true;
+}
+
+void FAtomicFileWriter::DiscardStream(IFileHandle* Handle, const FString& TempPath)
+{
+	delete Handle;
+	FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*TempPath);
+}
+
+void FAtomicFileWriter::GetCommitStats(int64& OutNumFilesCommitted, int64& OutNumFileSyncs, int64& OutNumBatches, int64& OutNumDirectorySyncs)
+{
+	OutNumFilesCommitted = AtomicFileWriter::NumFilesCommitted;
+	OutNumFileSyncs = AtomicFileWriter::NumFileSyncs;
+	OutNumBatches = AtomicFileWriter::NumBatches;
+	OutNumDirectorySyncs = AtomicFileWriter::NumDirectorySyncs;
+}
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Configurator.BenchmarkAtomicWrites [NumFiles] [MaxThreads]
+ * Writes NumFiles small exports from 1..MaxThreads threads, reports throughput, the per-file
+ * data syncs against the rename batches and directory syncs they shared, and checks every
+ * file reads back complete.
+ */
+static FAutoConsoleCommand GBenchmarkAtomicWritesCommand(
+	TEXT("Configurator.BenchmarkAtomicWrites"),
+	TEXT("Time crash-safe export writes across thread counts. Usage: Configurator.BenchmarkAtomicWrites [NumFiles] [MaxThreads]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumFiles = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 200;
+		const int32 MaxThreads = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		const FString Directory = FPaths::ProjectSavedDir() / TEXT("AtomicWriteBenchmark");
+		if (!PlatformFile.CreateDirectoryTree(*Directory))
+		{
+			UE_LOG(LogTemp, Error, TEXT("BenchmarkAtomicWrites: Failed to create directory: %s"), *Directory);
+			return;
+		}
+
+		for (int32 Threads = 1; Threads <= MaxThreads; Threads = Threads < MaxThreads ? FMath::Min(Threads * 2, MaxThreads) : MaxThreads + 1)
+		{
+			int64 FilesBefore = 0;
+			int64 FileSyncsBefore = 0;
+			int64 BatchesBefore = 0;
+			int64 DirectorySyncsBefore = 0;
+			FAtomicFileWriter::GetCommitStats(FilesBefore, FileSyncsBefore, BatchesBefore, DirectorySyncsBefore);
+
+			std::atomic<int32> NumFailed{0};
+			const double StartTime = FPlatformTime::Seconds();
+			ParallelFor(Threads, [&](int32 Worker)
+			{
+				for (int32 Index = Worker; Index < NumFiles; Index += Threads)
+				{
+					const FString Json = FString::Printf(TEXT("{\n\t\"configurationName\": \"Benchmark %d\",\n\t\"selectedVariants\": [ \"Paint: Red\", \"Wheels: Sport\" ]\n}"), Index);
+					FString ErrorMessage;
+					if (!FAtomicFileWriter::SaveStringToFile(Json, Directory / FString::Printf(TEXT("Export_%d.json"), Index), ErrorMessage))
+					{
+						UE_LOG(LogTemp, Error, TEXT("BenchmarkAtomicWrites: %s"), *ErrorMessage);
+						++NumFailed;
+					}
+				}
+			});
+			const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+
+			int64 FilesAfter = 0;
+			int64 FileSyncsAfter = 0;
+			int64 BatchesAfter = 0;
+			int64 DirectorySyncsAfter = 0;
+			FAtomicFileWriter::GetCommitStats(FilesAfter, FileSyncsAfter, BatchesAfter, DirectorySyncsAfter);
+
+			int32 NumIncomplete = 0;
+			for (int32 Index = 0; Index < NumFiles; ++Index)
+			{
+				FString Json;
+				if (!FFileHelper::LoadFileToString(Json, *(Directory / FString::Printf(TEXT("Export_%d.json"), Index))) || !Json.EndsWith(TEXT("}")))
+				{
+					++NumIncomplete;
+				}
+			}
+
+			UE_LOG(LogTemp, Display, TEXT("  %2d threads: %8.1f files/s  %5lld per-file data syncs  %5lld rename batches  %5lld directory syncs  %d failed  %d incomplete"),
+				Threads, NumFiles / FMath::Max(ElapsedSeconds, 1e-6), FileSyncsAfter - FileSyncsBefore, BatchesAfter - BatchesBefore,
+				DirectorySyncsAfter - DirectorySyncsBefore, NumFailed.load(), NumIncomplete);
+		}
+
+		PlatformFile.DeleteDirectoryRecursively(*Directory);
+	}));
+
+#endif
@@ -8,15 +8,57 @@
 #include "VariantManagerContent/Public/LevelVariantSets.h"
 // -----------------------
 #include "PDFGenerator.h"
+#include "VariantSelection.h"
+#include "ConfigurationShareCode.h"
+#include "AtomicFileWriter.h"
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
 #include "Misc/DateTime.h"
 #include "HAL/PlatformFileManager.h"
+#include "HAL/FileManager.h"
 #include "HAL/PlatformProcess.h"
 #include "JsonObjectConverter.h"
 #include "LevelVariantSets.h"
 #include "LevelVariantSetsActor.h"
 
+namespace ConfigurationExportLibrary
+{
+	/**
+	 * A file is written after its Timestamp is taken, so its modification time is never earlier.
+	 * The margin covers daylight saving changes between export and lookup.
+	 */
+	static const FTimespan ModificationTimeMargin = FTimespan::FromDays(1);
+
+	/** Parse the "YYYY-MM-DD_HH-MM-SS" format written by GetFormattedTimestamp */
+	static bool ParseFormattedTimestamp(const FString& Timestamp, FDateTime& OutDateTime)
+	{
+		TArray<FString> Parts;
+		Timestamp.Replace(TEXT("_"), TEXT("-")).ParseIntoArray(Parts, TEXT("-"));
+		if (Parts.Num() != 6)
+		{
+			return false;
+		}
+
+		int32 Values[6];
+		for (int32 Index = 0; Index < 6; ++Index)
+		{
+			if (!Parts[Index].IsNumeric())
+			{
+				return false;
+			}
+			Values[Index] = FCString::Atoi(*Parts[Index]);
+		}
+
+		if (!FDateTime::Validate(Values[0], Values[1], Values[2], Values[3], Values[4], Values[5], 0))
+		{
+			return false;
+		}
+
+		OutDateTime = FDateTime(Values[0], Values[1], Values[2], Values[3], Values[4], Values[5]);
+		return true;
+	}
+}
+
 void UConfigurationExportLibrary::ExportConfigurationToJSON(
 	const FConfigurationData& ConfigData,
 	const FString& ConfigurationName,
@@ -53,15 +95,16 @@ void UConfigurationExportLibrary::ExportConfigurationToJSON(
 		return;
 	}
 
-	// Save to file
-	if (FFileHelper::SaveStringToFile(JsonString, *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	// Save to file; a crash mid-write leaves the previous file rather than a truncated one
+	FString ErrorMessage;
+	if (FAtomicFileWriter::SaveStringToFile(JsonString, FilePath, ErrorMessage))
 	{
 		Success = true;
 		UE_LOG(LogTemp, Log, TEXT("Configuration exported to: %s"), *FilePath);
 	}
 	else
 	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to save JSON file: %s"), *FilePath);
+		UE_LOG(LogTemp, Error, TEXT("Failed to save JSON file: %s (%s)"), *FilePath, *ErrorMessage);
 	}
 }
 
@@ -116,6 +159,132 @@ void UConfigurationExportLibrary::GeneratePDFFromJSON(
 	}
 }
 
+void UConfigurationExportLibrary::AppendConfigurationToPDF(
+	const FConfigurationData& ConfigData,
+	const FString& PDFPath,
+	bool& Success,
+	int32& NumObjectsWritten,
+	FString& ErrorMessage)
+{
+	Success = false;
+	NumObjectsWritten = 0;
+	ErrorMessage = TEXT("");
+
+	if (PDFPath.IsEmpty())
+	{
+		ErrorMessage = TEXT("PDF path is empty");
+		return;
+	}
+
+	Success = FPDFGenerator::AppendPDFRevision(ConfigData, PDFPath, NumObjectsWritten, ErrorMessage);
+	if (!Success)
+	{
+		UE_LOG(LogTemp, Error, TEXT("PDF update failed: %s"), *ErrorMessage);
+	}
+}
+
+void UConfigurationExportLibrary::ExportCatalogToPDF(
+	const FDateTime& From,
+	const FDateTime& To,
+	const FString& CatalogName,
+	bool& Success,
+	FString& PDFOutputPath,
+	int32& NumConfigurations,
+	FString& ErrorMessage)
+{
+	Success = false;
+	NumConfigurations = 0;
+	ErrorMessage = TEXT("");
+
+	if (To < From)
+	{
+		ErrorMessage = TEXT("Date range ends before it starts");
+		return;
+	}
+
+	const FString SaveDir = FPaths::ProjectSavedDir() / TEXT("Configurations");
+	TArray<FString> FileNames;
+	IFileManager::Get().FindFiles(FileNames, *(SaveDir / TEXT("*.json")), true, false);
+
+	// Only the sort key is kept per file; the catalog parses each file again just before
+	// adding it, so memory does not grow with the size of the date range
+	struct FCatalogEntry
+	{
+		FDateTime ExportTime;
+		FString JsonFilePath;
+	};
+
+	const FTimespan UtcToLocal = FDateTime::Now() - FDateTime::UtcNow();
+	TArray<FCatalogEntry> InRange;
+	int32 NumSkippedByModificationTime = 0;
+	for (const FString& FileName : FileNames)
+	{
+		const FString JsonFilePath = SaveDir / FileName;
+
+		// Files last written before the range began cannot have been exported in it; skip them unread
+		const FDateTime ModificationTime = IFileManager::Get().GetTimeStamp(*JsonFilePath) + UtcToLocal;
+		if (ModificationTime < From - ConfigurationExportLibrary::ModificationTimeMargin)
+		{
+			++NumSkippedByModificationTime;
+			continue;
+		}
+
+		FConfigurationData ConfigData;
+		FString LoadErrorMessage;
+		if (!FPDFGenerator::LoadConfigurationFromJSON(JsonFilePath, ConfigData, LoadErrorMessage))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Skipping %s: %s"), *JsonFilePath, *LoadErrorMessage);
+			continue;
+		}
+
+		// Files without a readable Timestamp fall back to their modification time
+		FDateTime ExportTime;
+		if (!ConfigurationExportLibrary::ParseFormattedTimestamp(ConfigData.Timestamp, ExportTime))
+		{
+			ExportTime = ModificationTime;
+		}
+
+		if (ExportTime >= From && ExportTime <= To)
+		{
+			InRange.Add({ ExportTime, JsonFilePath });
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Catalog: %d of %d configuration files in range (%d skipped by modification time)"),
+		InRange.Num(), FileNames.Num(), NumSkippedByModificationTime);
+
+	if (InRange.Num() == 0)
+	{
+		ErrorMessage = FString::Printf(TEXT("No configurations exported between %s and %s"), *From.ToString(), *To.ToString());
+		return;
+	}
+
+	InRange.Sort([](const FCatalogEntry& A, const FCatalogEntry& B)
+	{
+		return A.ExportTime < B.ExportTime || (A.ExportTime == B.ExportTime && A.JsonFilePath < B.JsonFilePath);
+	});
+
+	TArray<FString> JsonFilePaths;
+	JsonFilePaths.Reserve(InRange.Num());
+	for (FCatalogEntry& Entry : InRange)
+	{
+		JsonFilePaths.Add(MoveTemp(Entry.JsonFilePath));
+	}
+	InRange.Empty();
+
+	// The name comes from the caller; keep path separators out so the catalog stays in Saved/PDFs
+	const FString FileName = CatalogName.IsEmpty()
+		? FString::Printf(TEXT("Catalog_%s.pdf"), *GetFormattedTimestamp())
+		: FString::Printf(TEXT("%s.pdf"), *FPaths::MakeValidFileName(CatalogName));
+	PDFOutputPath = FPaths::ProjectSavedDir() / TEXT("PDFs") / FileName;
+
+	Success = FPDFGenerator::GenerateCatalogFromJSON(JsonFilePaths, PDFOutputPath, NumConfigurations, ErrorMessage);
+	if (!Success)
+	{
+		UE_LOG(LogTemp, Error, TEXT("PDF catalog generation failed: %s"), *ErrorMessage);
+	}
+}
+
 void UConfigurationExportLibrary::ExportVariantSetsToPDF(
 	ALevelVariantSetsActor* LevelVariantSetsActor,
 	const FString& ConfigurationName,
@@ -152,34 +321,20 @@ void UConfigurationExportLibrary::ExportVariantSetsToPDF(
 	ConfigData.SelectedEnvironment = TEXT("Default");
 	ConfigData.SelectedCamera = TEXT("Default");
 
-	// Iterate through all VariantSets and their Variants
-	int32 NumVariantSets = VariantSets->GetNumVariantSets();
-	UE_LOG(LogTemp, Log, TEXT("Found %d variant sets"), NumVariantSets);
+	// Capture the active variant of every VariantSet
+	TArray<int32> Selection;
+	FVariantSelection::CaptureSelection(VariantSets, Selection);
+	UE_LOG(LogTemp, Log, TEXT("Found %d variant sets"), Selection.Num());
+
+	FVariantSelection::DescribeSelection(VariantSets, Selection, ConfigData.SelectedVariants);
 
-	for (int32 i = 0; i < NumVariantSets; ++i)
+	// Add a share code so the configuration can be restored from the PDF alone
+	FConfigurationShareCode::FSchema Schema;
+	FString ShareCodeError;
+	if (!FConfigurationShareCode::BuildSchema(VariantSets, Schema)
+		|| !FConfigurationShareCode::Encode(Schema, Selection, ConfigData.ShareCode, ShareCodeError))
 	{
-		UVariantSet* VariantSet = VariantSets->GetVariantSet(i);
-		if (VariantSet)
-		{
-			FString VariantSetName = VariantSet->GetDisplayText().ToString();
-			int32 NumVariants = VariantSet->GetNumVariants();
-			
-			// Find the active variant in this set
-			FString ActiveVariantName = TEXT("None");
-			for (int32 j = 0; j < NumVariants; ++j)
-			{
-				UVariant* Variant = VariantSet->GetVariant(j);
-				// Only collect if this variant is active
-				if (Variant && Variant->IsActive())
-				{
-					ActiveVariantName = Variant->GetDisplayText().ToString();
-					break; // Found the active one, stop
-				}
-			}
-			// Add variant set with its active variant
-			FString FullVariantPath = VariantSetName + TEXT(": ") + ActiveVariantName;
-			ConfigData.SelectedVariants.Add(FullVariantPath);
-		}
+		UE_LOG(LogTemp, Warning, TEXT("Failed to build share code: %s"), *ShareCodeError);
 	}
 
 	UE_LOG(LogTemp, Log, TEXT("Collected %d variants"), ConfigData.SelectedVariants.Num());
@@ -199,6 +354,152 @@ void UConfigurationExportLibrary::ExportVariantSetsToPDF(
 	GeneratePDFFromJSON(JsonFilePath, Success, PDFOutputPath, ErrorMessage);
 }
 
+void UConfigurationExportLibrary::ApplyConfiguration(
+	ALevelVariantSetsActor* LevelVariantSetsActor,
+	const FConfigurationData& ConfigData,
+	bool& Success,
+	int32& NumSetsSwitched,
+	FString& ErrorMessage)
+{
+	Success = false;
+	NumSetsSwitched = 0;
+	ErrorMessage = TEXT("");
+
+	ULevelVariantSets* VariantSets = LevelVariantSetsActor ? LevelVariantSetsActor->GetLevelVariantSets(true) : nullptr;
+	if (!VariantSets)
+	{
+		ErrorMessage = TEXT("No LevelVariantSets asset found in the actor.");
+		UE_LOG(LogTemp, Error, TEXT("ApplyConfiguration: %s"), *ErrorMessage);
+		return;
+	}
+
+	// Prefer the share code: it is exact and avoids matching display names
+	TArray<int32> Selection;
+	bool bResolved = false;
+	if (!ConfigData.ShareCode.IsEmpty())
+	{
+		FConfigurationShareCode::FSchema Schema;
+		FConfigurationShareCode::BuildSchema(VariantSets, Schema);
+		bResolved = FConfigurationShareCode::Decode(Schema, ConfigData.ShareCode, Selection, ErrorMessage);
+		if (!bResolved)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("ApplyConfiguration: Ignoring share code (%s), falling back to variant names"), *ErrorMessage);
+		}
+	}
+
+	if (!bResolved && !FVariantSelection::ResolveSelection(VariantSets, ConfigData.SelectedVariants, Selection, ErrorMessage))
+	{
+		UE_LOG(LogTemp, Error, TEXT("ApplyConfiguration: %s"), *ErrorMessage);
+		return;
+	}
+
+	Success = FVariantSelection::ApplySelection(LevelVariantSetsActor, Selection, NumSetsSwitched, ErrorMessage);
+	if (Success)
+	{
+		UE_LOG(LogTemp, Log, TEXT("ApplyConfiguration: Switched %d of %d variant sets"), NumSetsSwitched, Selection.Num());
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("ApplyConfiguration: %s"), *ErrorMessage);
+	}
+}
+
+void UConfigurationExportLibrary::GetShareCode(
+	ALevelVariantSetsActor* LevelVariantSetsActor,
+	bool& Success,
+	FString& ShareCode)
+{
+	Success = false;
+	ShareCode = TEXT("");
+
+	ULevelVariantSets* VariantSets = LevelVariantSetsActor ? LevelVariantSetsActor->GetLevelVariantSets(true) : nullptr;
+	if (!VariantSets)
+	{
+		UE_LOG(LogTemp, Error, TEXT("GetShareCode: No LevelVariantSets asset found."));
+		return;
+	}
+
+	TArray<int32> Selection;
+	FVariantSelection::CaptureSelection(VariantSets, Selection);
+
+	FConfigurationShareCode::FSchema Schema;
+	FConfigurationShareCode::BuildSchema(VariantSets, Schema);
+
+	FString ErrorMessage;
+	Success = FConfigurationShareCode::Encode(Schema, Selection, ShareCode, ErrorMessage);
+	if (!Success)
+	{
+		UE_LOG(LogTemp, Error, TEXT("GetShareCode: %s"), *ErrorMessage);
+	}
+}
+
+void UConfigurationExportLibrary::DecodeShareCode(
+	ALevelVariantSetsActor* LevelVariantSetsActor,
+	const FString& ShareCode,
+	FConfigurationData& ConfigData,
+	bool& Success,
+	FString& ErrorMessage)
+{
+	Success = false;
+	ConfigData = FConfigurationData();
+	ErrorMessage = TEXT("");
+
+	ULevelVariantSets* VariantSets = LevelVariantSetsActor ? LevelVariantSetsActor->GetLevelVariantSets(true) : nullptr;
+	if (!VariantSets)
+	{
+		ErrorMessage = TEXT("No LevelVariantSets asset found in the actor.");
+		return;
+	}
+
+	FConfigurationShareCode::FSchema Schema;
+	FConfigurationShareCode::BuildSchema(VariantSets, Schema);
+
+	TArray<int32> Selection;
+	if (!FConfigurationShareCode::Decode(Schema, ShareCode, Selection, ErrorMessage))
+	{
+		return;
+	}
+
+	ConfigData.ConfigurationName = TEXT("ProductConfiguration");
+	ConfigData.Timestamp = GetFormattedTimestamp();
+	ConfigData.SelectedEnvironment = TEXT("Default");
+	ConfigData.SelectedCamera = TEXT("Default");
+	ConfigData.ShareCode = ShareCode;
+	FVariantSelection::DescribeSelection(VariantSets, Selection, ConfigData.SelectedVariants);
+
+	Success = true;
+}
+
+void UConfigurationExportLibrary::ApplyShareCode(
+	ALevelVariantSetsActor* LevelVariantSetsActor,
+	const FString& ShareCode,
+	bool& Success,
+	FString& ErrorMessage)
+{
+	Success = false;
+	ErrorMessage = TEXT("");
+
+	ULevelVariantSets* VariantSets = LevelVariantSetsActor ? LevelVariantSetsActor->GetLevelVariantSets(true) : nullptr;
+	if (!VariantSets)
+	{
+		ErrorMessage = TEXT("No LevelVariantSets asset found in the actor.");
+		return;
+	}
+
+	FConfigurationShareCode::FSchema Schema;
+	FConfigurationShareCode::BuildSchema(VariantSets, Schema);
+
+	TArray<int32> Selection;
+	if (!FConfigurationShareCode::Decode(Schema, ShareCode, Selection, ErrorMessage))
+	{
+		UE_LOG(LogTemp, Error, TEXT("ApplyShareCode: %s"), *ErrorMessage);
+		return;
+	}
+
+	int32 NumSetsSwitched = 0;
+	Success = FVariantSelection::ApplySelection(LevelVariantSetsActor, Selection, NumSetsSwitched, ErrorMessage);
+}
+
 FString UConfigurationExportLibrary::GetFormattedTimestamp()
 {
 	FDateTime Now = FDateTime::Now();
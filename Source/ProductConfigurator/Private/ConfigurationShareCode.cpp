@@ -0,0 +1,415 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ConfigurationShareCode.h"
+#include "VariantSet.h"
+#include "Variant.h"
+#include "LevelVariantSets.h"
+#include "Misc/Crc.h"
+#include "Math/RandomStream.h"
+#include "HAL/IConsoleManager.h"
+
+namespace ShareCode
+{
+	// Crockford base32: no I, L, O or U so codes survive being read aloud or retyped
+	static const TCHAR* Alphabet = TEXT("0123456789ABCDEFGHJKMNPQRSTVWXYZ");
+
+	// Version byte + schema hash
+	static constexpr int32 HeaderBytes = 3;
+	static constexpr int32 ChecksumBytes = 2;
+
+	/** Value = Value * Radix + Digit on a little-endian byte array */
+	static void MultiplyAdd(TArray<uint8>& Value, uint32 Radix, uint32 Digit)
+	{
+		uint64 Carry = Digit;
+		for (uint8& Byte : Value)
+		{
+			const uint64 Product = (uint64)Byte * Radix + Carry;
+			Byte = (uint8)(Product & 0xFF);
+			Carry = Product >> 8;
+		}
+		while (Carry != 0)
+		{
+			Value.Add((uint8)(Carry & 0xFF));
+			Carry >>= 8;
+		}
+	}
+
+	/** Value = Value / Radix on a little-endian byte array, returning the remainder */
+	static uint32 DivMod(TArray<uint8>& Value, uint32 Radix)
+	{
+		uint64 Remainder = 0;
+		for (int32 Index = Value.Num() - 1; Index >= 0; --Index)
+		{
+			const uint64 Current = (Remainder << 8) | Value[Index];
+			Value[Index] = (uint8)(Current / Radix);
+			Remainder = Current % Radix;
+		}
+		return (uint32)Remainder;
+	}
+
+	static uint16 Checksum(const uint8* Data, int32 Num)
+	{
+		const uint32 Crc = FCrc::MemCrc32(Data, Num);
+		return (uint16)((Crc >> 16) ^ (Crc & 0xFFFF));
+	}
+
+	static void HashString(uint32& Crc, const FString& Value)
+	{
+		FTCHARToUTF8 ValueUTF8(*Value);
+		Crc = FCrc::MemCrc32(ValueUTF8.Get(), ValueUTF8.Length(), Crc);
+		// Separator so "AB"+"C" and "A"+"BC" hash differently
+		const uint8 Separator = 0;
+		Crc = FCrc::MemCrc32(&Separator, 1, Crc);
+	}
+
+	/** Bytes needed to store the largest mixed-radix value (every digit at Radix - 1) */
+	static int32 ValueBytesFor(const TArray<uint32>& Radices)
+	{
+		TArray<uint8> MaxValue;
+		for (const uint32 Radix : Radices)
+		{
+			MultiplyAdd(MaxValue, Radix, Radix - 1);
+		}
+		while (MaxValue.Num() > 0 && MaxValue.Last() == 0)
+		{
+			MaxValue.Pop(EAllowShrinking::No);
+		}
+		return MaxValue.Num();
+	}
+}
+
+bool FConfigurationShareCode::BuildSchema(ULevelVariantSets* VariantSets, FSchema& OutSchema)
+{
+	OutSchema = FSchema();
+
+	if (!VariantSets)
+	{
+		return false;
+	}
+
+	const int32 NumVariantSets = VariantSets->GetNumVariantSets();
+	OutSchema.Radices.Reserve(NumVariantSets);
+
+	uint32 Crc = 0;
+
+	for (int32 SetIndex = 0; SetIndex < NumVariantSets; ++SetIndex)
+	{
+		UVariantSet* VariantSet = VariantSets->GetVariantSet(SetIndex);
+		const int32 NumVariants = VariantSet ? VariantSet->GetNumVariants() : 0;
+
+		if (VariantSet)
+		{
+			ShareCode::HashString(Crc, VariantSet->GetDisplayText().ToString());
+			for (int32 VariantIndex = 0; VariantIndex < NumVariants; ++VariantIndex)
+			{
+				UVariant* Variant = VariantSet->GetVariant(VariantIndex);
+				ShareCode::HashString(Crc, Variant ? Variant->GetDisplayText().ToString() : FString());
+			}
+		}
+		ShareCode::HashString(Crc, TEXT("|"));
+
+		OutSchema.Radices.Add((uint32)NumVariants + 1);
+	}
+
+	OutSchema.SchemaHash = (uint16)((Crc >> 16) ^ (Crc & 0xFFFF));
+	OutSchema.ValueBytes = ShareCode::ValueBytesFor(OutSchema.Radices);
+	return true;
+}
+
+bool FConfigurationShareCode::Encode(const FSchema& Schema, const TArray<int32>& Selection, FString& OutShareCode, FString& OutErrorMessage)
+{
+	OutShareCode.Empty();
+	OutErrorMessage.Empty();
+
+	if (Selection.Num() != Schema.Radices.Num())
+	{
+		OutErrorMessage = FString::Printf(TEXT("Selection has %d entries but the schema has %d variant sets"),
+			Selection.Num(), Schema.Radices.Num());
+		return false;
+	}
+
+	// Last set is the most significant digit so decoding yields sets in order
+	TArray<uint8> Value;
+	Value.Reserve(Schema.ValueBytes);
+	for (int32 SetIndex = Selection.Num() - 1; SetIndex >= 0; --SetIndex)
+	{
+		const uint32 Radix = Schema.Radices[SetIndex];
+		const uint32 Digit = Selection[SetIndex] == INDEX_NONE ? 0 : (uint32)Selection[SetIndex] + 1;
+		if (Selection[SetIndex] < INDEX_NONE || Digit >= Radix)
+		{
+			OutErrorMessage = FString::Printf(TEXT("Variant index %d is out of range for variant set %d"), Selection[SetIndex], SetIndex);
+			return false;
+		}
+		ShareCode::MultiplyAdd(Value, Radix, Digit);
+	}
+	Value.SetNumZeroed(Schema.ValueBytes);
+
+	TArray<uint8> Bytes;
+	Bytes.Reserve(ShareCode::HeaderBytes + Schema.ValueBytes + ShareCode::ChecksumBytes);
+	Bytes.Add(FormatVersion);
+	Bytes.Add((uint8)(Schema.SchemaHash & 0xFF));
+	Bytes.Add((uint8)(Schema.SchemaHash >> 8));
+	Bytes.Append(Value);
+
+	const uint16 Check = ShareCode::Checksum(Bytes.GetData(), Bytes.Num());
+	Bytes.Add((uint8)(Check & 0xFF));
+	Bytes.Add((uint8)(Check >> 8));
+
+	OutShareCode = BytesToBase32(Bytes);
+	return true;
+}
+
+bool FConfigurationShareCode::Decode(const FSchema& Schema, const FString& ShareCode, TArray<int32>& OutSelection, FString& OutErrorMessage)
+{
+	OutSelection.Reset();
+	OutErrorMessage.Empty();
+
+	TArray<uint8> Bytes;
+	if (!Base32ToBytes(ShareCode, Bytes))
+	{
+		OutErrorMessage = TEXT("Share code contains invalid characters or a mistyped last character");
+		return false;
+	}
+
+	if (Bytes.Num() != ShareCode::HeaderBytes + Schema.ValueBytes + ShareCode::ChecksumBytes)
+	{
+		OutErrorMessage = TEXT("Share code has the wrong length for this product");
+		return false;
+	}
+
+	const int32 CheckOffset = Bytes.Num() - ShareCode::ChecksumBytes;
+	const uint16 StoredCheck = (uint16)(Bytes[CheckOffset] | (Bytes[CheckOffset + 1] << 8));
+	if (StoredCheck != ShareCode::Checksum(Bytes.GetData(), CheckOffset))
+	{
+		OutErrorMessage = TEXT("Share code checksum mismatch (mistyped code?)");
+		return false;
+	}
+
+	if (Bytes[0] != FormatVersion)
+	{
+		OutErrorMessage = FString::Printf(TEXT("Unsupported share code version %d"), Bytes[0]);
+		return false;
+	}
+
+	const uint16 StoredSchema = (uint16)(Bytes[1] | (Bytes[2] << 8));
+	if (StoredSchema != Schema.SchemaHash)
+	{
+		OutErrorMessage = TEXT("Share code was created for a different set of variants");
+		return false;
+	}
+
+	TArray<uint8> Value(Bytes.GetData() + ShareCode::HeaderBytes, Schema.ValueBytes);
+	OutSelection.Reserve(Schema.Radices.Num());
+	for (const uint32 Radix : Schema.Radices)
+	{
+		const uint32 Digit = ShareCode::DivMod(Value, Radix);
+		OutSelection.Add(Digit == 0 ? INDEX_NONE : (int32)Digit - 1);
+	}
+
+	// Anything left over means the value exceeded the schema's range
+	for (const uint8 Byte : Value)
+	{
+		if (Byte != 0)
+		{
+			OutSelection.Reset();
+			OutErrorMessage = TEXT("Share code value is out of range for this product");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+FString FConfigurationShareCode::BytesToBase32(const TArray<uint8>& Bytes)
+{
+	FString Result;
+	Result.Reserve((Bytes.Num() * 8 + 4) / 5);
+
+	uint32 Buffer = 0;
+	int32 BitsInBuffer = 0;
+	for (const uint8 Byte : Bytes)
+	{
+		Buffer = (Buffer << 8) | Byte;
+		BitsInBuffer += 8;
+		while (BitsInBuffer >= 5)
+		{
+			BitsInBuffer -= 5;
+			Result.AppendChar(ShareCode::Alphabet[(Buffer >> BitsInBuffer) & 0x1F]);
+		}
+	}
+	if (BitsInBuffer > 0)
+	{
+		Result.AppendChar(ShareCode::Alphabet[(Buffer << (5 - BitsInBuffer)) & 0x1F]);
+	}
+
+	return Result;
+}
+
+bool FConfigurationShareCode::Base32ToBytes(const FString& Code, TArray<uint8>& OutBytes)
+{
+	OutBytes.Reset();
+
+	uint32 Buffer = 0;
+	int32 BitsInBuffer = 0;
+	for (TCHAR Char : Code)
+	{
+		if (Char == TEXT('-') || FChar::IsWhitespace(Char))
+		{
+			continue;
+		}
+
+		Char = FChar::ToUpper(Char);
+		if (Char == TEXT('O'))
+		{
+			Char = TEXT('0');
+		}
+		else if (Char == TEXT('I') || Char == TEXT('L'))
+		{
+			Char = TEXT('1');
+		}
+
+		int32 Digit = INDEX_NONE;
+		for (int32 Index = 0; Index < 32; ++Index)
+		{
+			if (ShareCode::Alphabet[Index] == Char)
+			{
+				Digit = Index;
+				break;
+			}
+		}
+		if (Digit == INDEX_NONE)
+		{
+			return false;
+		}
+
+		Buffer = (Buffer << 5) | (uint32)Digit;
+		BitsInBuffer += 5;
+		if (BitsInBuffer >= 8)
+		{
+			BitsInBuffer -= 8;
+			OutBytes.Add((uint8)((Buffer >> BitsInBuffer) & 0xFF));
+		}
+	}
+
+	// BytesToBase32 leaves fewer than 5 padding bits, all zero; anything else would let
+	// several strings decode to the same code
+	return BitsInBuffer < 5 && (Buffer & ((1u << BitsInBuffer) - 1)) == 0;
+}
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Configurator.TestShareCodes [NumSelections]
+ * Round-trips random selections through a synthetic schema, including codes retyped with
+ * hyphens, lowercase and Crockford substitutions, then checks that a code with one mistyped
+ * character fails the checksum, that non-zero padding bits or an extra character are rejected,
+ * and that a code decoded against a changed schema is rejected.
+ */
+static FAutoConsoleCommand GTestShareCodesCommand(
+	TEXT("Configurator.TestShareCodes"),
+	TEXT("Round-trip and corrupt random share codes. Usage: Configurator.TestShareCodes [NumSelections]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumSelections = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1000;
+		FRandomStream Random(0x5EED);
+
+		// Shaped like a product: a few sets with two options, a few with many, one empty
+		FConfigurationShareCode::FSchema Schema;
+		Schema.SchemaHash = 0xC0DE;
+		Schema.Radices = { 3, 3, 9, 5, 25, 2, 13, 4, 1, 7 };
+		Schema.ValueBytes = ShareCode::ValueBytesFor(Schema.Radices);
+
+		// Same layout, different names
+		FConfigurationShareCode::FSchema RenamedSchema = Schema;
+		RenamedSchema.SchemaHash = Schema.SchemaHash ^ 1;
+
+		int32 NumRoundTripFailures = 0;
+		int32 NumRetypedFailures = 0;
+		int32 NumUndetectedTypos = 0;
+		int32 NumUndetectedSchemaChanges = 0;
+		int32 NumNonCanonicalAccepted = 0;
+		int32 CodeLength = 0;
+
+		for (int32 Iteration = 0; Iteration < NumSelections; ++Iteration)
+		{
+			TArray<int32> Selection;
+			for (const uint32 Radix : Schema.Radices)
+			{
+				Selection.Add(Random.RandRange(0, (int32)Radix - 1) - 1);
+			}
+
+			FString Code;
+			FString ErrorMessage;
+			TArray<int32> Decoded;
+			if (!FConfigurationShareCode::Encode(Schema, Selection, Code, ErrorMessage)
+				|| !FConfigurationShareCode::Decode(Schema, Code, Decoded, ErrorMessage) || Decoded != Selection)
+			{
+				++NumRoundTripFailures;
+				continue;
+			}
+			CodeLength = Code.Len();
+
+			// As a person might retype it: grouped, lowercase, O and I/L for 0 and 1
+			FString Retyped;
+			for (int32 Index = 0; Index < Code.Len(); ++Index)
+			{
+				if (Index > 0 && Index % 4 == 0)
+				{
+					Retyped.AppendChar(TEXT('-'));
+				}
+				const TCHAR Char = Code[Index];
+				Retyped.AppendChar(Char == TEXT('0') ? TEXT('o') : Char == TEXT('1') ? TEXT('l') : FChar::ToLower(Char));
+			}
+			if (!FConfigurationShareCode::Decode(Schema, Retyped, Decoded, ErrorMessage) || Decoded != Selection)
+			{
+				++NumRetypedFailures;
+			}
+
+			// One mistyped character. The last one also carries padding bits, so a typo there may not change the bytes.
+			FString Typo = Code;
+			const int32 TypoIndex = Random.RandRange(0, Code.Len() - 2);
+			const TCHAR* Original = FCString::Strchr(ShareCode::Alphabet, Code[TypoIndex]);
+			const int32 Shift = Random.RandRange(1, 31);
+			Typo[TypoIndex] = ShareCode::Alphabet[((Original - ShareCode::Alphabet) + Shift) % 32];
+			if (FConfigurationShareCode::Decode(Schema, Typo, Decoded, ErrorMessage) || !ErrorMessage.Contains(TEXT("checksum")))
+			{
+				++NumUndetectedTypos;
+			}
+
+			if (FConfigurationShareCode::Decode(RenamedSchema, Code, Decoded, ErrorMessage) || !ErrorMessage.Contains(TEXT("different set of variants")))
+			{
+				++NumUndetectedSchemaChanges;
+			}
+
+			// Only the canonical spelling decodes: set padding bits, or an extra character, must be rejected
+			const int32 LastDigit = (int32)(FCString::Strchr(ShareCode::Alphabet, Code[Code.Len() - 1]) - ShareCode::Alphabet);
+			const int32 NumPaddingBits = Code.Len() * 5 - (ShareCode::HeaderBytes + Schema.ValueBytes + ShareCode::ChecksumBytes) * 8;
+			FString Padded = Code;
+			Padded[Padded.Len() - 1] = ShareCode::Alphabet[LastDigit | 1];
+			if ((NumPaddingBits > 0 && FConfigurationShareCode::Decode(Schema, Padded, Decoded, ErrorMessage))
+				|| FConfigurationShareCode::Decode(Schema, Code + TEXT("0"), Decoded, ErrorMessage))
+			{
+				++NumNonCanonicalAccepted;
+			}
+		}
+
+		// A set added to the product changes the payload size, so old codes no longer fit
+		FConfigurationShareCode::FSchema ExtendedSchema = Schema;
+		ExtendedSchema.Radices.Add(40);
+		ExtendedSchema.ValueBytes = ShareCode::ValueBytesFor(ExtendedSchema.Radices);
+		TArray<int32> Selection;
+		Selection.Init(INDEX_NONE, Schema.Radices.Num());
+		FString Code;
+		FString ErrorMessage;
+		TArray<int32> Decoded;
+		FConfigurationShareCode::Encode(Schema, Selection, Code, ErrorMessage);
+		const bool bExtendedRejected = !FConfigurationShareCode::Decode(ExtendedSchema, Code, Decoded, ErrorMessage);
+
+		const bool bValid = NumRoundTripFailures == 0 && NumRetypedFailures == 0 && NumUndetectedTypos == 0
+			&& NumUndetectedSchemaChanges == 0 && NumNonCanonicalAccepted == 0 && bExtendedRejected;
+		UE_LOG(LogTemp, Display, TEXT("Configurator.TestShareCodes: %d selections, %d-character codes; %d round-trip failures, %d retyped failures, %d undetected typos, %d undetected schema changes, %d non-canonical codes accepted, extended schema %s (%s)"),
+			NumSelections, CodeLength, NumRoundTripFailures, NumRetypedFailures, NumUndetectedTypos, NumUndetectedSchemaChanges, NumNonCanonicalAccepted,
+			bExtendedRejected ? TEXT("rejected") : TEXT("ACCEPTED"), bValid ? TEXT("valid") : TEXT("INVALID"));
+	}));
+
+#endif
@@ -0,0 +1,614 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PDFCatalogWriter.h"
+#include "PDFObjectWriter.h"
+#include "PDFDocument.h"
+#include "PDFFont.h"
+#include "PDFIncrementalUpdate.h"
+#include "PDFParsing.h"
+#include "AtomicFileWriter.h"
+#include "ConfigurationExportLibrary.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+namespace PDFCatalogWriter
+{
+	// Written to disk whenever this much is buffered, and always after each configuration
+	static constexpr int32 FlushThreshold = 256 * 1024;
+
+	// Entries per node of the /Dests name tree
+	static constexpr int32 NameTreeFanOut = 64;
+
+	// Kids per /Pages node above the configuration nodes
+	static constexpr int32 PageTreeFanOut = 64;
+
+	static FString Ref(int32 ObjectNumber)
+	{
+		return FString::Printf(TEXT("%d 0 R"), ObjectNumber);
+	}
+
+	static FString FitDestination(int32 PageObject)
+	{
+		return FString::Printf(TEXT("[%d 0 R /Fit]"), PageObject);
+	}
+}
+
+FPDFCatalogWriter::FPDFCatalogWriter(TSharedRef<const FPDFLayoutProgram> InLayout, const FPDFWriteOptions& InOptions)
+	: Layout(InLayout)
+	, Options(InOptions)
+{
+}
+
+FPDFCatalogWriter::~FPDFCatalogWriter()
+{
+	// A catalog that was never finished must not leave a temp file behind
+	Discard();
+}
+
+bool FPDFCatalogWriter::Open(const FString& PdfFilePath, FString& OutErrorMessage)
+{
+	check(!FileHandle);
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const FString PDFDirectory = FPaths::GetPath(PdfFilePath);
+	if (!PlatformFile.DirectoryExists(*PDFDirectory) && !PlatformFile.CreateDirectoryTree(*PDFDirectory))
+	{
+		OutErrorMessage = FString::Printf(TEXT("Failed to create directory: %s"), *PDFDirectory);
+		return false;
+	}
+
+	FileHandle = FAtomicFileWriter::OpenStream(PdfFilePath, TempPath, OutErrorMessage);
+	if (!FileHandle)
+	{
+		return false;
+	}
+	FilePath = PdfFilePath;
+
+	Writer = MakeUnique<FPDFObjectWriter>(Buffer);
+	Writer->WriteHeader();
+
+	// Objects that refer to everything else are written by Finish; only their numbers are needed now
+	CatalogObject = AllocateObject();
+	PageTreeObject = AllocateObject();
+	ResourcesObject = AllocateObject();
+	for (int32 FontIndex = 0; FontIndex < Layout->GetFonts().Num(); ++FontIndex)
+	{
+		FontObjects.Add(AllocateObject());
+	}
+
+	return true;
+}
+
+void FPDFCatalogWriter::WriteImages(const FConfigurationData& ConfigData, TMap<FString, FPDFLayoutImage>& OutImages)
+{
+	TArray<FString> Paths;
+	Layout->CollectImagePaths(ConfigData, Paths);
+
+	for (const FString& Path : Paths)
+	{
+		if (const FPDFLayoutImage* Written = ImagesByPath.Find(Path))
+		{
+			OutImages.Add(Path, *Written);
+			continue;
+		}
+
+		// Same resolution as FPDFGenerator::ResolveImages
+		const FString FullPath = FPaths::IsRelative(Path) ? FPaths::ProjectContentDir() / Path : Path;
+
+		FString ErrorMessage;
+		TSharedPtr<const FPDFImage> Image = FPDFImageCache::Load(FullPath, ErrorMessage);
+		if (!Image.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Leaving image out of PDF: %s"), *ErrorMessage);
+			continue;
+		}
+
+		// Identical files come back from the cache as the same object
+		FWrittenImage* WrittenImage = ImagesByContent.Find(Image.Get());
+		if (!WrittenImage || WrittenImage->Image.Pin() != Image)
+		{
+			FString ImageEntries = Image->GetStreamEntries();
+			if (Image->AlphaData.Num() > 0)
+			{
+				const int32 MaskObject = AllocateObject();
+				Writer->WriteStreamObject(MaskObject, Image->GetAlphaStreamEntries(), Image->AlphaData.GetData(), Image->AlphaData.Num());
+				ImageEntries += FString::Printf(TEXT(" /SMask %s"), *PDFCatalogWriter::Ref(MaskObject));
+			}
+
+			const int32 ImageObject = AllocateObject();
+			Writer->WriteStreamObject(ImageObject, ImageEntries, Image->Data.GetData(), Image->Data.Num());
+
+			FWrittenImage& NewImage = ImagesByContent.Add(Image.Get());
+			NewImage.Image = Image;
+			NewImage.Resource.ResourceName = FString::Printf(TEXT("Im%d"), ++NumImages);
+			NewImage.Resource.Width = Image->Width;
+			NewImage.Resource.Height = Image->Height;
+			ImageResources += FString::Printf(TEXT(" /%s %s"), *NewImage.Resource.ResourceName, *PDFCatalogWriter::Ref(ImageObject));
+			WrittenImage = &NewImage;
+		}
+
+		ImagesByPath.Add(Path, WrittenImage->Resource);
+		OutImages.Add(Path, WrittenImage->Resource);
+	}
+}
+
+FString FPDFCatalogWriter::MakeDestinationName(const FConfigurationData& ConfigData)
+{
+	// Plain ASCII keys sort the same as bytes, which is the order the name tree requires
+	FString BaseName;
+	for (const TCHAR Char : ConfigData.ConfigurationName)
+	{
+		const bool bKeep = (Char >= '0' && Char <= '9') || (Char >= 'A' && Char <= 'Z') || (Char >= 'a' && Char <= 'z') || Char == '-';
+		BaseName.AppendChar(bKeep ? Char : TEXT('_'));
+	}
+	if (BaseName.IsEmpty())
+	{
+		BaseName = TEXT("Configuration");
+	}
+
+	FString Name = BaseName;
+	for (int32 Suffix = 2; DestinationNames.Contains(Name); ++Suffix)
+	{
+		Name = FString::Printf(TEXT("%s_%d"), *BaseName, Suffix);
+	}
+	DestinationNames.Add(Name);
+	return Name;
+}
+
+bool FPDFCatalogWriter::AddConfiguration(const FConfigurationData& ConfigData, FString& OutErrorMessage)
+{
+	if (!FileHandle)
+	{
+		OutErrorMessage = TEXT("Catalog is not open");
+		return false;
+	}
+
+	TArray<FPDFLayoutPage> Pages;
+	Layout->Paginate(ConfigData, Pages);
+	if (Pages.Num() == 0)
+	{
+		return true;
+	}
+
+	// New images go into the file before the pages that draw them
+	FPDFDocumentImages Images;
+	WriteImages(ConfigData, Images.ByPath);
+
+	TArray<FPDFPageStream> PageStreams;
+	FPDFGenerator::SerializePages(ConfigData, *Layout, Pages, Images, Options, PageStreams);
+	for (const FPDFPageStream& PageStream : PageStreams)
+	{
+		UsedGlyphs.Append(PageStream.Glyphs);
+	}
+
+	const FString MediaBox = FString::Printf(TEXT("[0 0 %s %s]"),
+		*FString::SanitizeFloat(Layout->GetPageWidth(), 0), *FString::SanitizeFloat(Layout->GetPageHeight(), 0));
+
+	// Each configuration gets its own /Pages node; Finish writes it once its place in the page tree is known
+	FConfigurationNode& ConfigurationNode = ConfigurationNodes.AddDefaulted_GetRef();
+	ConfigurationNode.Object = AllocateObject();
+	ConfigurationNode.NumPages = PageStreams.Num();
+	int32 FirstPage = 0;
+	for (FPDFPageStream& PageStream : PageStreams)
+	{
+		const int32 ContentObject = AllocateObject();
+		Writer->WriteStreamObject(ContentObject, PageStream.bCompressed ? TEXT("/Filter /FlateDecode") : FString(), PageStream.Bytes.GetData(), PageStream.Bytes.Num());
+		PageStream.Bytes.Empty();
+
+		const int32 PageObject = AllocateObject();
+		Writer->WriteObject(PageObject, FString::Printf(
+			TEXT("<< /Type /Page /Parent %s /MediaBox %s /Contents %s /Resources %s >>"),
+			*PDFCatalogWriter::Ref(ConfigurationNode.Object), *MediaBox, *PDFCatalogWriter::Ref(ContentObject), *PDFCatalogWriter::Ref(ResourcesObject)));
+
+		FirstPage = FirstPage ? FirstPage : PageObject;
+		ConfigurationNode.Kids += (ConfigurationNode.Kids.IsEmpty() ? TEXT("") : TEXT(" ")) + PDFCatalogWriter::Ref(PageObject);
+
+		if (Buffer.Num() >= PDFCatalogWriter::FlushThreshold && !FlushOutput())
+		{
+			OutErrorMessage = FString::Printf(TEXT("Failed to write PDF file: %s"), *TempPath);
+			Discard();
+			return false;
+		}
+	}
+
+	if (!FlushOutput())
+	{
+		OutErrorMessage = FString::Printf(TEXT("Failed to write PDF file: %s"), *TempPath);
+		Discard();
+		return false;
+	}
+
+	FEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Title = ConfigData.ConfigurationName.IsEmpty() ? FString::Printf(TEXT("Configuration %d"), Entries.Num()) : ConfigData.ConfigurationName;
+	if (!ConfigData.Timestamp.IsEmpty())
+	{
+		Entry.Title += FString::Printf(TEXT(" (%s)"), *ConfigData.Timestamp);
+	}
+	Entry.DestinationName = MakeDestinationName(ConfigData);
+	Entry.FirstPage = FirstPage;
+
+	TotalPages += PageStreams.Num();
+	return true;
+}
+
+int32 FPDFCatalogWriter::WriteOutline()
+{
+	// One flat level: a bookmark per configuration, in the order they were added
+	const int32 OutlineRoot = AllocateObject();
+	const int32 FirstItem = NextObjectNumber;
+	NextObjectNumber += Entries.Num();
+
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	{
+		FString Item = FString::Printf(TEXT("<< /Title %s /Parent %s"), *EncodeTextString(Entries[Index].Title), *PDFCatalogWriter::Ref(OutlineRoot));
+		if (Index > 0)
+		{
+			Item += FString::Printf(TEXT(" /Prev %s"), *PDFCatalogWriter::Ref(FirstItem + Index - 1));
+		}
+		if (Index + 1 < Entries.Num())
+		{
+			Item += FString::Printf(TEXT(" /Next %s"), *PDFCatalogWriter::Ref(FirstItem + Index + 1));
+		}
+		Item += FString::Printf(TEXT(" /Dest %s >>"), *PDFCatalogWriter::FitDestination(Entries[Index].FirstPage));
+		Writer->WriteObject(FirstItem + Index, Item);
+	}
+
+	Writer->WriteObject(OutlineRoot, FString::Printf(TEXT("<< /Type /Outlines /First %s /Last %s /Count %d >>"),
+		*PDFCatalogWriter::Ref(FirstItem), *PDFCatalogWriter::Ref(FirstItem + Entries.Num() - 1), Entries.Num()));
+	return OutlineRoot;
+}
+
+void FPDFCatalogWriter::WritePageTree()
+{
+	auto WriteNode = [this](const FConfigurationNode& Node, int32 Parent)
+	{
+		Writer->WriteObject(Node.Object, FString::Printf(TEXT("<< /Type /Pages /Parent %s /Kids [%s] /Count %d >>"),
+			*PDFCatalogWriter::Ref(Parent), *Node.Kids, Node.NumPages));
+	};
+
+	// Configuration nodes are the lowest level; each level above, the root included, holds up to PageTreeFanOut kids
+	TArray<FConfigurationNode> Level = MoveTemp(ConfigurationNodes);
+	while (Level.Num() > PDFCatalogWriter::PageTreeFanOut)
+	{
+		TArray<FConfigurationNode> Parents;
+		for (int32 Start = 0; Start < Level.Num(); Start += PDFCatalogWriter::PageTreeFanOut)
+		{
+			const int32 End = FMath::Min(Start + PDFCatalogWriter::PageTreeFanOut, Level.Num());
+
+			FConfigurationNode& Parent = Parents.AddDefaulted_GetRef();
+			Parent.Object = AllocateObject();
+			for (int32 Index = Start; Index < End; ++Index)
+			{
+				WriteNode(Level[Index], Parent.Object);
+				Parent.Kids += (Parent.Kids.IsEmpty() ? TEXT("") : TEXT(" ")) + PDFCatalogWriter::Ref(Level[Index].Object);
+				Parent.NumPages += Level[Index].NumPages;
+			}
+		}
+		Level = MoveTemp(Parents);
+	}
+
+	FString Kids;
+	for (const FConfigurationNode& Node : Level)
+	{
+		WriteNode(Node, PageTreeObject);
+		Kids += (Kids.IsEmpty() ? TEXT("") : TEXT(" ")) + PDFCatalogWriter::Ref(Node.Object);
+	}
+	Writer->WriteObject(PageTreeObject, FString::Printf(TEXT("<< /Type /Pages /Kids [%s] /Count %d >>"), *Kids, TotalPages));
+}
+
+int32 FPDFCatalogWriter::WriteNameTree(const TArray<int32>& SortedEntries)
+{
+	struct FNode
+	{
+		int32 Object = 0;
+		FString First;
+		FString Last;
+	};
+
+	// Leaves hold the (name, destination) pairs; each level above holds up to NameTreeFanOut kids
+	TArray<FNode> Level;
+	for (int32 Start = 0; Start < SortedEntries.Num(); Start += PDFCatalogWriter::NameTreeFanOut)
+	{
+		const int32 End = FMath::Min(Start + PDFCatalogWriter::NameTreeFanOut, SortedEntries.Num());
+
+		FNode& Leaf = Level.AddDefaulted_GetRef();
+		Leaf.Object = AllocateObject();
+		Leaf.First = EncodeTextString(Entries[SortedEntries[Start]].DestinationName);
+		Leaf.Last = EncodeTextString(Entries[SortedEntries[End - 1]].DestinationName);
+
+		FString Names;
+		for (int32 Index = Start; Index < End; ++Index)
+		{
+			const FEntry& Entry = Entries[SortedEntries[Index]];
+			Names += FString::Printf(TEXT("%s%s %s"), Names.IsEmpty() ? TEXT("") : TEXT(" "), *EncodeTextString(Entry.DestinationName), *PDFCatalogWriter::FitDestination(Entry.FirstPage));
+		}
+		Writer->WriteObject(Leaf.Object, FString::Printf(TEXT("<< /Limits [%s %s] /Names [%s] >>"), *Leaf.First, *Leaf.Last, *Names));
+	}
+
+	while (Level.Num() > PDFCatalogWriter::NameTreeFanOut)
+	{
+		TArray<FNode> Parents;
+		for (int32 Start = 0; Start < Level.Num(); Start += PDFCatalogWriter::NameTreeFanOut)
+		{
+			const int32 End = FMath::Min(Start + PDFCatalogWriter::NameTreeFanOut, Level.Num());
+
+			FNode& Parent = Parents.AddDefaulted_GetRef();
+			Parent.Object = AllocateObject();
+			Parent.First = Level[Start].First;
+			Parent.Last = Level[End - 1].Last;
+
+			FString Kids;
+			for (int32 Index = Start; Index < End; ++Index)
+			{
+				Kids += (Kids.IsEmpty() ? TEXT("") : TEXT(" ")) + PDFCatalogWriter::Ref(Level[Index].Object);
+			}
+			Writer->WriteObject(Parent.Object, FString::Printf(TEXT("<< /Limits [%s %s] /Kids [%s] >>"), *Parent.First, *Parent.Last, *Kids));
+		}
+		Level = MoveTemp(Parents);
+	}
+
+	// The root has no /Limits
+	FString Kids;
+	for (const FNode& Node : Level)
+	{
+		Kids += (Kids.IsEmpty() ? TEXT("") : TEXT(" ")) + PDFCatalogWriter::Ref(Node.Object);
+	}
+	const int32 Root = AllocateObject();
+	Writer->WriteObject(Root, FString::Printf(TEXT("<< /Kids [%s] >>"), *Kids));
+	return Root;
+}
+
+void FPDFCatalogWriter::WriteEmbeddedFont(int32 FontIndex)
+{
+	// One subset for the whole catalog, built as a small object graph and numbered into the file
+	const TSet<uint16> NoGlyphs;
+	const TSet<uint16>& Glyphs = UsedGlyphs.Fonts.IsValidIndex(FontIndex) ? UsedGlyphs.Fonts[FontIndex] : NoGlyphs;
+
+	FPDFDocument FontObjectGraph;
+	TArray<int32> Ids;
+	const int32 FontId = Layout->GetFonts()[FontIndex].TrueType->GetSubset(Glyphs)->AddToDocument(FontObjectGraph, Ids);
+
+	TArray<int32> ObjectNumbers;
+	ObjectNumbers.Init(0, FontObjectGraph.NumObjects() + 1);
+	for (const int32 Id : Ids)
+	{
+		ObjectNumbers[Id] = Id == FontId ? FontObjects[FontIndex] : AllocateObject();
+	}
+
+	for (int32 Id = 1; Id <= FontObjectGraph.NumObjects(); ++Id)
+	{
+		const FPDFDocument::FObject& Object = FontObjectGraph.GetObject(Id);
+		if (Object.bIsStream)
+		{
+			Writer->WriteStreamObject(ObjectNumbers[Id], FPDFDocument::ResolveReferences(Object.StreamEntries, ObjectNumbers), Object.Stream.GetData(), Object.Stream.Num());
+		}
+		else
+		{
+			Writer->WriteObject(ObjectNumbers[Id], FPDFDocument::ResolveReferences(Object.Body, ObjectNumbers));
+		}
+	}
+}
+
+bool FPDFCatalogWriter::Finish(FString& OutErrorMessage)
+{
+	if (!FileHandle)
+	{
+		OutErrorMessage = TEXT("Catalog is not open");
+		return false;
+	}
+
+	if (Entries.Num() == 0)
+	{
+		OutErrorMessage = TEXT("Catalog has no pages");
+		Discard();
+		return false;
+	}
+
+	// Fonts and the resource dictionary every page points at
+	const TArray<FPDFLayoutFont>& Fonts = Layout->GetFonts();
+	FString FontResources;
+	for (int32 FontIndex = 0; FontIndex < Fonts.Num(); ++FontIndex)
+	{
+		if (Fonts[FontIndex].TrueType.IsValid())
+		{
+			WriteEmbeddedFont(FontIndex);
+		}
+		else
+		{
+			Writer->WriteObject(FontObjects[FontIndex], FString::Printf(TEXT("<< /Type /Font /Subtype /Type1 /BaseFont /%s >>"), *Fonts[FontIndex].BaseFont));
+		}
+		FontResources += FString::Printf(TEXT(" /%s %s"), *Fonts[FontIndex].ResourceName, *PDFCatalogWriter::Ref(FontObjects[FontIndex]));
+	}
+
+	Writer->WriteObject(ResourcesObject, ImageResources.IsEmpty()
+		? FString::Printf(TEXT("<< /Font <<%s >> >>"), *FontResources)
+		: FString::Printf(TEXT("<< /Font <<%s >> /XObject <<%s >> >>"), *FontResources, *ImageResources));
+
+	WritePageTree();
+
+	const int32 OutlineRoot = WriteOutline();
+
+	TArray<int32> SortedEntries;
+	SortedEntries.SetNumUninitialized(Entries.Num());
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	{
+		SortedEntries[Index] = Index;
+	}
+	SortedEntries.Sort([this](int32 A, int32 B)
+	{
+		return Entries[A].DestinationName.Compare(Entries[B].DestinationName, ESearchCase::CaseSensitive) < 0;
+	});
+	const int32 NameTreeRoot = WriteNameTree(SortedEntries);
+
+	Writer->WriteObject(CatalogObject, FString::Printf(TEXT("<< /Type /Catalog /Pages %s /Outlines %s /PageMode /UseOutlines /Names << /Dests %s >> >>"),
+		*PDFCatalogWriter::Ref(PageTreeObject), *PDFCatalogWriter::Ref(OutlineRoot), *PDFCatalogWriter::Ref(NameTreeRoot)));
+	Writer->WriteXrefAndTrailer(CatalogObject);
+
+	if (!FlushOutput())
+	{
+		OutErrorMessage = FString::Printf(TEXT("Failed to write PDF file: %s"), *TempPath);
+		Discard();
+		return false;
+	}
+
+	IFileHandle* CompletedHandle = FileHandle;
+	FileHandle = nullptr;
+	if (!FAtomicFileWriter::CommitStream(CompletedHandle, TempPath, FilePath, OutErrorMessage))
+	{
+		OutErrorMessage = FString::Printf(TEXT("Failed to write PDF file: %s (%s)"), *FilePath, *OutErrorMessage);
+		return false;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("PDF catalog generated successfully: %s (%d configurations, %d pages)"), *FilePath, Entries.Num(), TotalPages);
+	return true;
+}
+
+bool FPDFCatalogWriter::FlushOutput()
+{
+	if (Buffer.Num() == 0)
+	{
+		return true;
+	}
+
+	if (!FileHandle || !FileHandle->Write(Buffer.GetData(), Buffer.Num()))
+	{
+		return false;
+	}
+
+	Writer->ReleaseOutput();
+	return true;
+}
+
+void FPDFCatalogWriter::Discard()
+{
+	if (FileHandle)
+	{
+		FAtomicFileWriter::DiscardStream(FileHandle, TempPath);
+		FileHandle = nullptr;
+	}
+}
+
+FString FPDFCatalogWriter::EncodeTextString(const FString& Text)
+{
+	bool bIsASCII = true;
+	for (const TCHAR Char : Text)
+	{
+		if ((uint32)Char >= 127)
+		{
+			bIsASCII = false;
+			break;
+		}
+	}
+
+	if (bIsASCII)
+	{
+		FString Literal = TEXT("(");
+		for (const TCHAR Char : Text)
+		{
+			if (Char == '\\' || Char == '(' || Char == ')')
+			{
+				Literal.AppendChar(TEXT('\\'));
+				Literal.AppendChar(Char);
+			}
+			else if ((uint32)Char < 32)
+			{
+				// A raw CR would be read back as LF, and other control bytes upset some viewers
+				Literal += FString::Printf(TEXT("\\%03o"), (int32)Char);
+			}
+			else
+			{
+				Literal.AppendChar(Char);
+			}
+		}
+		Literal.AppendChar(TEXT(')'));
+		return Literal;
+	}
+
+	FTCHARToUTF16 TextUTF16(*Text);
+	FString Hex = TEXT("<FEFF");
+	for (int32 Index = 0; Index < TextUTF16.Length(); ++Index)
+	{
+		Hex += FString::Printf(TEXT("%04X"), (uint32)TextUTF16.Get()[Index]);
+	}
+	Hex.AppendChar(TEXT('>'));
+	return Hex;
+}
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * PDF.TestCatalog [NumConfigurations] [VariantsPerConfiguration]
+ * Streams synthetic configurations into one catalog, then reads the file back and checks
+ * that every cross-reference entry points at its object and the outline has one bookmark
+ * per configuration.
+ */
+static FAutoConsoleCommand GTestCatalogCommand(
+	TEXT("PDF.TestCatalog"),
+	TEXT("Write and validate a catalog PDF. Usage: PDF.TestCatalog [NumConfigurations] [VariantsPerConfiguration]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumConfigurations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 2000;
+		const int32 NumVariants = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 12;
+		const FString PdfFilePath = FPaths::ProjectSavedDir() / TEXT("PDFs") / TEXT("CatalogTest.pdf");
+
+		FPDFWriteOptions Options;
+		Options.bCompressStreams = true;
+
+		FString ErrorMessage;
+		const double StartTime = FPlatformTime::Seconds();
+		{
+			FPDFCatalogWriter Catalog(FPDFLayoutTemplateCache::Get(), Options);
+			bool bSuccess = Catalog.Open(PdfFilePath, ErrorMessage);
+			for (int32 Index = 0; bSuccess && Index < NumConfigurations; ++Index)
+			{
+				FConfigurationData ConfigData;
+				// Repeated names exercise the unique destination names, the control character the title escaping
+				ConfigData.ConfigurationName = FString::Printf(TEXT("Guitar (%s)\tNo. %d"), Index % 3 ? TEXT("Red") : TEXT("Sunburst"), Index / 2);
+				ConfigData.Timestamp = FString::Printf(TEXT("2026-01-%02d_12-00-00"), 1 + Index % 28);
+				for (int32 Variant = 0; Variant < NumVariants; ++Variant)
+				{
+					ConfigData.SelectedVariants.Add(FString::Printf(TEXT("Variant Set %d: Option %d"), Variant, (Index + Variant) % 7));
+				}
+				bSuccess = Catalog.AddConfiguration(ConfigData, ErrorMessage);
+			}
+			if (!bSuccess || !Catalog.Finish(ErrorMessage))
+			{
+				UE_LOG(LogTemp, Error, TEXT("PDF.TestCatalog: %s"), *ErrorMessage);
+				return;
+			}
+		}
+		const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		TArray<uint8> Bytes;
+		FFileHelper::LoadFileToArray(Bytes, *PdfFilePath);
+
+		TMap<int64, int64> ObjectOffsets;
+		int64 LastXref = 0;
+		int64 Size = 0;
+		int32 NumSections = 0;
+		if (!FPDFIncrementalUpdate::ReadXrefChain(Bytes, ObjectOffsets, LastXref, Size, NumSections, ErrorMessage))
+		{
+			UE_LOG(LogTemp, Error, TEXT("PDF.TestCatalog: %s"), *ErrorMessage);
+			return;
+		}
+
+		int32 NumMisplaced = 0;
+		for (const TPair<int64, int64>& Entry : ObjectOffsets)
+		{
+			NumMisplaced += PDFParsing::IsObjectAt(Bytes, Entry.Value, Entry.Key) ? 0 : 1;
+		}
+
+		const int64 OutlinesAt = PDFParsing::FindBytes(Bytes, "/Type /Outlines", 0, Bytes.Num());
+		int64 OutlineCount = 0;
+		PDFParsing::ReadKeyInteger(Bytes, OutlinesAt, Bytes.Num(), "/Count", OutlineCount);
+
+		UE_LOG(LogTemp, Display, TEXT("PDF.TestCatalog: %d configurations, %lld objects, %lld bytes in %.1f ms; %d misplaced objects, %lld bookmarks (%s)"),
+			NumConfigurations, Size - 1, (int64)Bytes.Num(), ElapsedMs, NumMisplaced, OutlineCount,
+			NumMisplaced == 0 && ObjectOffsets.Num() == Size - 1 && OutlineCount == NumConfigurations ? TEXT("valid") : TEXT("INVALID"));
+	}));
+
+#endif
@@ -0,0 +1,102 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PDFDocument.h"
+#include "PDFObjectWriter.h"
+
+namespace PDFDocument
+{
+	// Control character that never appears in escaped PDF strings or names
+	static constexpr TCHAR RefMarker = TEXT('\x01');
+	static const TCHAR RefMarkerString[] = { RefMarker, TEXT('\0') };
+}
+
+int32 FPDFDocument::AddObject(const FString& Body)
+{
+	FObject& Object = Objects.AddDefaulted_GetRef();
+	Object.Body = Body;
+	return Objects.Num();
+}
+
+int32 FPDFDocument::AddStreamObject(const FString& StreamEntries, TArray<uint8>&& Stream)
+{
+	FObject& Object = Objects.AddDefaulted_GetRef();
+	Object.StreamEntries = StreamEntries;
+	Object.Stream = MoveTemp(Stream);
+	Object.bIsStream = true;
+	return Objects.Num();
+}
+
+int32 FPDFDocument::ReserveObject()
+{
+	Objects.AddDefaulted();
+	return Objects.Num();
+}
+
+FString FPDFDocument::Ref(int32 Id)
+{
+	return FString::Printf(TEXT("%c%d%c"), PDFDocument::RefMarker, Id, PDFDocument::RefMarker);
+}
+
+FString FPDFDocument::ResolveReferences(const FString& Body, const TArray<int32>& ObjectNumbers)
+{
+	int32 Marker = INDEX_NONE;
+	if (!Body.FindChar(PDFDocument::RefMarker, Marker))
+	{
+		return Body;
+	}
+
+	FString Result;
+	Result.Reserve(Body.Len() + 16);
+
+	int32 Start = 0;
+	while (Marker != INDEX_NONE)
+	{
+		const int32 End = Body.Find(PDFDocument::RefMarkerString, ESearchCase::CaseSensitive, ESearchDir::FromStart, Marker + 1);
+		check(End != INDEX_NONE);
+
+		Result.Append(*Body + Start, Marker - Start);
+
+		const int32 Id = FCString::Atoi(*Body.Mid(Marker + 1, End - Marker - 1));
+		const int32 Number = ObjectNumbers.Num() > 0 ? ObjectNumbers[Id] : Id;
+		Result.Appendf(TEXT("%d 0 R"), Number);
+
+		Start = End + 1;
+		Marker = Body.Find(PDFDocument::RefMarkerString, ESearchCase::CaseSensitive, ESearchDir::FromStart, Start);
+	}
+
+	Result.Append(*Body + Start, Body.Len() - Start);
+	return Result;
+}
+
+void FPDFDocument::SerializeObject(int32 Id, const TArray<int32>& ObjectNumbers, TArray<uint8>& OutBytes) const
+{
+	const FObject& Object = GetObject(Id);
+	const int32 Number = ObjectNumbers.Num() > 0 ? ObjectNumbers[Id] : Id;
+
+	if (Object.bIsStream)
+	{
+		FPDFObjectWriter::AppendStreamObject(OutBytes, Number, ResolveReferences(Object.StreamEntries, ObjectNumbers), Object.Stream.GetData(), Object.Stream.Num());
+	}
+	else
+	{
+		FPDFObjectWriter::AppendObject(OutBytes, Number, ResolveReferences(Object.Body, ObjectNumbers));
+	}
+}
+
+void FPDFDocument::Write(FPDFObjectWriter& Writer) const
+{
+	for (int32 Id = 1; Id <= Objects.Num(); ++Id)
+	{
+		const FObject& Object = GetObject(Id);
+		if (Object.bIsStream)
+		{
+			Writer.WriteStreamObject(Id, ResolveReferences(Object.StreamEntries, TArray<int32>()), Object.Stream.GetData(), Object.Stream.Num());
+		}
+		else
+		{
+			Writer.WriteObject(Id, ResolveReferences(Object.Body, TArray<int32>()));
+		}
+	}
+
+	Writer.WriteXrefAndTrailer(Catalog);
+}
@@ -0,0 +1,1031 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PDFFont.h"
+#include "PDFDocument.h"
+#include "PDFGenerator.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
+
+namespace PDFFont
+{
+	static constexpr uint32 MakeTag(ANSICHAR A, ANSICHAR B, ANSICHAR C, ANSICHAR D)
+	{
+		return ((uint32)(uint8)A << 24) | ((uint32)(uint8)B << 16) | ((uint32)(uint8)C << 8) | (uint32)(uint8)D;
+	}
+
+	static FString TagToString(uint32 Tag)
+	{
+		FString Name;
+		for (int32 Shift = 24; Shift >= 0; Shift -= 8)
+		{
+			Name.AppendChar((TCHAR)((Tag >> Shift) & 0xFF));
+		}
+		return Name;
+	}
+
+	// TrueType data is big-endian
+	static uint16 ReadU16(const uint8* Bytes)
+	{
+		return (uint16)((Bytes[0] << 8) | Bytes[1]);
+	}
+
+	static int16 ReadS16(const uint8* Bytes)
+	{
+		return (int16)ReadU16(Bytes);
+	}
+
+	static uint32 ReadU32(const uint8* Bytes)
+	{
+		return ((uint32)Bytes[0] << 24) | ((uint32)Bytes[1] << 16) | ((uint32)Bytes[2] << 8) | (uint32)Bytes[3];
+	}
+
+	static void SetU16(uint8* Bytes, uint16 Value)
+	{
+		Bytes[0] = (uint8)(Value >> 8);
+		Bytes[1] = (uint8)Value;
+	}
+
+	static void SetU32(uint8* Bytes, uint32 Value)
+	{
+		Bytes[0] = (uint8)(Value >> 24);
+		Bytes[1] = (uint8)(Value >> 16);
+		Bytes[2] = (uint8)(Value >> 8);
+		Bytes[3] = (uint8)Value;
+	}
+
+	static void WriteU16(TArray<uint8>& Out, uint16 Value)
+	{
+		const int32 Start = Out.AddUninitialized(2);
+		SetU16(Out.GetData() + Start, Value);
+	}
+
+	static void WriteU32(TArray<uint8>& Out, uint32 Value)
+	{
+		const int32 Start = Out.AddUninitialized(4);
+		SetU32(Out.GetData() + Start, Value);
+	}
+
+	static void PadTo4(TArray<uint8>& Out)
+	{
+		while (Out.Num() % 4 != 0)
+		{
+			Out.Add(0);
+		}
+	}
+
+	/** Sum of big-endian 32-bit words, the last one zero-padded */
+	static uint32 CalcChecksum(const uint8* Bytes, int64 Num)
+	{
+		uint32 Sum = 0;
+		int64 Index = 0;
+		for (; Index + 4 <= Num; Index += 4)
+		{
+			Sum += ReadU32(Bytes + Index);
+		}
+		if (Index < Num)
+		{
+			uint8 Last[4] = { 0, 0, 0, 0 };
+			FMemory::Memcpy(Last, Bytes + Index, Num - Index);
+			Sum += ReadU32(Last);
+		}
+		return Sum;
+	}
+
+	static void AppendHex(TArray<uint8>& Out, uint16 Value)
+	{
+		static const ANSICHAR Digits[] = "0123456789ABCDEF";
+		Out.Add(Digits[(Value >> 12) & 0xF]);
+		Out.Add(Digits[(Value >> 8) & 0xF]);
+		Out.Add(Digits[(Value >> 4) & 0xF]);
+		Out.Add(Digits[Value & 0xF]);
+	}
+
+	/** UTF-16BE hex of a code point, as ToUnicode expects */
+	static FString UTF16Hex(uint32 CodePoint)
+	{
+		if (CodePoint < 0x10000)
+		{
+			return FString::Printf(TEXT("%04X"), CodePoint);
+		}
+		const uint32 Offset = CodePoint - 0x10000;
+		return FString::Printf(TEXT("%04X%04X"), 0xD800 + (Offset >> 10), 0xDC00 + (Offset & 0x3FF));
+	}
+
+	// Composite glyph component flags
+	static constexpr uint16 ArgsAreWords = 0x0001;
+	static constexpr uint16 HaveScale = 0x0008;
+	static constexpr uint16 MoreComponents = 0x0020;
+	static constexpr uint16 HaveXYScale = 0x0040;
+	static constexpr uint16 HaveTwoByTwo = 0x0080;
+
+	/** Call Visit with the offset of each component glyph id inside a composite glyph (simple glyphs have none) */
+	static void ForEachComponent(const uint8* Glyph, int32 Length, TFunctionRef<void(int32)> Visit)
+	{
+		if (Length < 10 || ReadS16(Glyph) >= 0)
+		{
+			return;
+		}
+
+		int32 Pos = 10;
+		while (Pos + 4 <= Length)
+		{
+			const uint16 Flags = ReadU16(Glyph + Pos);
+			Visit(Pos + 2);
+
+			Pos += 4 + ((Flags & ArgsAreWords) ? 4 : 2);
+			if (Flags & HaveScale)
+			{
+				Pos += 2;
+			}
+			else if (Flags & HaveXYScale)
+			{
+				Pos += 4;
+			}
+			else if (Flags & HaveTwoByTwo)
+			{
+				Pos += 8;
+			}
+
+			if (!(Flags & MoreComponents))
+			{
+				break;
+			}
+		}
+	}
+
+	static FString CompressedEntries(TArray<uint8>& InOutStream)
+	{
+		return FPDFGenerator::CompressStream(InOutStream) ? FString(TEXT("/Filter /FlateDecode")) : FString();
+	}
+
+	struct FCachedFont
+	{
+		FDateTime Timestamp;
+		TSharedPtr<const FPDFTrueTypeFont> Font;
+	};
+
+	struct FCache
+	{
+		FCriticalSection Lock;
+		TMap<FString, FCachedFont> Fonts;
+	};
+
+	static FCache& GetCache()
+	{
+		static FCache Cache;
+		return Cache;
+	}
+}
+
+int32 FPDFFontSubset::AddToDocument(FPDFDocument& Document, TArray<int32>& OutObjects, const FString& Key) const
+{
+	const int32 FontFileObject = Document.AddStreamObject(FontFile.Entries, TArray<uint8>(FontFile.Bytes));
+	const int32 DescriptorObject = Document.AddObject(FString::Printf(TEXT("<< /Type /FontDescriptor /FontName /%s %s /FontFile2 %s >>"),
+		*BaseFont, *DescriptorEntries, *FPDFDocument::Ref(FontFileObject)));
+
+	const int32 CIDToGIDMapObject = Document.AddStreamObject(CIDToGIDMap.Entries, TArray<uint8>(CIDToGIDMap.Bytes));
+	const int32 CIDFontObject = Document.AddObject(FString::Printf(
+		TEXT("<< /Type /Font /Subtype /CIDFontType2 /BaseFont /%s /CIDSystemInfo << /Registry (Adobe) /Ordering (Identity) /Supplement 0 >> /FontDescriptor %s /W [%s] /CIDToGIDMap %s >>"),
+		*BaseFont, *FPDFDocument::Ref(DescriptorObject), *Widths, *FPDFDocument::Ref(CIDToGIDMapObject)));
+
+	const int32 ToUnicodeObject = Document.AddStreamObject(ToUnicode.Entries, TArray<uint8>(ToUnicode.Bytes));
+	const int32 FontObject = Document.AddObject(FString::Printf(
+		TEXT("<< /Type /Font /Subtype /Type0 /BaseFont /%s /Encoding /Identity-H /DescendantFonts [%s] /ToUnicode %s >>"),
+		*BaseFont, *FPDFDocument::Ref(CIDFontObject), *FPDFDocument::Ref(ToUnicodeObject)));
+
+	if (!Key.IsEmpty())
+	{
+		Document.GetObject(FontFileObject).Key = Key + TEXT("/FontFile");
+		Document.GetObject(DescriptorObject).Key = Key + TEXT("/Descriptor");
+		Document.GetObject(CIDToGIDMapObject).Key = Key + TEXT("/CIDToGIDMap");
+		Document.GetObject(CIDFontObject).Key = Key + TEXT("/CIDFont");
+		Document.GetObject(ToUnicodeObject).Key = Key + TEXT("/ToUnicode");
+		Document.GetObject(FontObject).Key = Key;
+	}
+
+	OutObjects.Append({ FontFileObject, DescriptorObject, CIDToGIDMapObject, CIDFontObject, ToUnicodeObject, FontObject });
+	return FontObject;
+}
+
+TSharedPtr<FPDFTrueTypeFont> FPDFTrueTypeFont::Parse(TArray<uint8>&& FileBytes, FString& OutErrorMessage)
+{
+	using namespace PDFFont;
+
+	TSharedPtr<FPDFTrueTypeFont> Font = MakeShared<FPDFTrueTypeFont>();
+	Font->Data = MoveTemp(FileBytes);
+	const uint8* Bytes = Font->Data.GetData();
+	const int32 Num = Font->Data.Num();
+
+	if (Num < 12)
+	{
+		OutErrorMessage = TEXT("File is too small to be a font");
+		return nullptr;
+	}
+
+	const uint32 Version = ReadU32(Bytes);
+	if (Version == MakeTag('O', 'T', 'T', 'O'))
+	{
+		OutErrorMessage = TEXT("Font has PostScript (CFF) outlines; only fonts with TrueType outlines can be embedded");
+		return nullptr;
+	}
+	if (Version == MakeTag('t', 't', 'c', 'f'))
+	{
+		OutErrorMessage = TEXT("Font collections (.ttc) are not supported; use a single .ttf file");
+		return nullptr;
+	}
+	if (Version != 0x00010000 && Version != MakeTag('t', 'r', 'u', 'e'))
+	{
+		OutErrorMessage = TEXT("Not a TrueType font");
+		return nullptr;
+	}
+
+	const int32 NumTables = ReadU16(Bytes + 4);
+	if (12 + NumTables * 16 > Num)
+	{
+		OutErrorMessage = TEXT("Font table directory is truncated");
+		return nullptr;
+	}
+
+	TMap<uint32, FTable> Tables;
+	for (int32 TableIndex = 0; TableIndex < NumTables; ++TableIndex)
+	{
+		const uint8* Record = Bytes + 12 + TableIndex * 16;
+		const uint32 Tag = ReadU32(Record);
+		const uint32 Offset = ReadU32(Record + 8);
+		const uint32 Length = ReadU32(Record + 12);
+		if ((int64)Offset + Length > Num)
+		{
+			OutErrorMessage = FString::Printf(TEXT("Font table '%s' is truncated"), *TagToString(Tag));
+			return nullptr;
+		}
+		Tables.Add(Tag, FTable{ (int32)Offset, (int32)Length });
+	}
+
+	auto FindTable = [&Tables](uint32 Tag, int32 MinLength, FTable& OutTable)
+	{
+		const FTable* Table = Tables.Find(Tag);
+		if (!Table || Table->Length < MinLength)
+		{
+			return false;
+		}
+		OutTable = *Table;
+		return true;
+	};
+
+	FTable Loca, Cmap;
+	if (!FindTable(MakeTag('h', 'e', 'a', 'd'), 54, Font->Head) || !FindTable(MakeTag('h', 'h', 'e', 'a'), 36, Font->Hhea)
+		|| !FindTable(MakeTag('m', 'a', 'x', 'p'), 6, Font->Maxp) || !FindTable(MakeTag('h', 'm', 't', 'x'), 0, Font->Hmtx)
+		|| !FindTable(MakeTag('l', 'o', 'c', 'a'), 0, Loca) || !FindTable(MakeTag('g', 'l', 'y', 'f'), 0, Font->Glyf)
+		|| !FindTable(MakeTag('c', 'm', 'a', 'p'), 4, Cmap))
+	{
+		OutErrorMessage = TEXT("Font is missing a required table (head, hhea, maxp, hmtx, loca, glyf or cmap)");
+		return nullptr;
+	}
+
+	// Hinting tables are copied into subsets unchanged
+	FindTable(MakeTag('c', 'v', 't', ' '), 1, Font->Cvt);
+	FindTable(MakeTag('f', 'p', 'g', 'm'), 1, Font->Fpgm);
+	FindTable(MakeTag('p', 'r', 'e', 'p'), 1, Font->Prep);
+
+	const uint8* Head = Bytes + Font->Head.Offset;
+	Font->UnitsPerEm = ReadU16(Head + 18);
+	if (ReadU32(Head + 12) != 0x5F0F3CF5 || Font->UnitsPerEm < 16 || Font->UnitsPerEm > 16384)
+	{
+		OutErrorMessage = TEXT("Font has an invalid head table");
+		return nullptr;
+	}
+	Font->XMin = ReadS16(Head + 36);
+	Font->YMin = ReadS16(Head + 38);
+	Font->XMax = ReadS16(Head + 40);
+	Font->YMax = ReadS16(Head + 42);
+	const bool bLongLoca = ReadS16(Head + 50) != 0;
+
+	const uint8* Hhea = Bytes + Font->Hhea.Offset;
+	Font->Ascent = ReadS16(Hhea + 4);
+	Font->Descent = ReadS16(Hhea + 6);
+	Font->CapHeight = Font->Ascent;
+	const int32 NumHMetrics = ReadU16(Hhea + 34);
+	const int32 NumGlyphs = ReadU16(Bytes + Font->Maxp.Offset + 4);
+
+	if (NumGlyphs == 0 || NumHMetrics == 0 || NumHMetrics > NumGlyphs)
+	{
+		OutErrorMessage = TEXT("Font has invalid glyph counts");
+		return nullptr;
+	}
+
+	// Glyphs after the last full metric repeat its advance width
+	if (Font->Hmtx.Length < NumHMetrics * 4 + (NumGlyphs - NumHMetrics) * 2)
+	{
+		OutErrorMessage = TEXT("Font hmtx table is truncated");
+		return nullptr;
+	}
+	const uint8* Hmtx = Bytes + Font->Hmtx.Offset;
+	Font->AdvanceWidths.SetNumUninitialized(NumGlyphs);
+	Font->LeftSideBearings.SetNumUninitialized(NumGlyphs);
+	for (int32 Glyph = 0; Glyph < NumGlyphs; ++Glyph)
+	{
+		if (Glyph < NumHMetrics)
+		{
+			Font->AdvanceWidths[Glyph] = ReadU16(Hmtx + Glyph * 4);
+			Font->LeftSideBearings[Glyph] = ReadS16(Hmtx + Glyph * 4 + 2);
+		}
+		else
+		{
+			Font->AdvanceWidths[Glyph] = Font->AdvanceWidths[NumHMetrics - 1];
+			Font->LeftSideBearings[Glyph] = ReadS16(Hmtx + NumHMetrics * 4 + (Glyph - NumHMetrics) * 2);
+		}
+	}
+
+	const int32 LocaEntrySize = bLongLoca ? 4 : 2;
+	if (Loca.Length < (NumGlyphs + 1) * LocaEntrySize)
+	{
+		OutErrorMessage = TEXT("Font loca table is truncated");
+		return nullptr;
+	}
+	Font->GlyphOffsets.SetNumUninitialized(NumGlyphs + 1);
+	for (int32 Glyph = 0; Glyph <= NumGlyphs; ++Glyph)
+	{
+		const uint8* Entry = Bytes + Loca.Offset + Glyph * LocaEntrySize;
+		const uint32 Offset = bLongLoca ? ReadU32(Entry) : (uint32)ReadU16(Entry) * 2;
+		if (Offset > (uint32)Font->Glyf.Length || (Glyph > 0 && Offset < Font->GlyphOffsets[Glyph - 1]))
+		{
+			OutErrorMessage = TEXT("Font has a corrupt loca table");
+			return nullptr;
+		}
+		Font->GlyphOffsets[Glyph] = Offset;
+	}
+
+	FTable OS2;
+	if (FindTable(MakeTag('O', 'S', '/', '2'), 10, OS2))
+	{
+		const uint8* Table = Bytes + OS2.Offset;
+		const uint16 EmbeddingFlags = ReadU16(Table + 8);
+
+		// Restricted license, or bitmap-only embedding (there are no bitmaps to embed)
+		if ((EmbeddingFlags & 0x000F) == 0x0002 || (EmbeddingFlags & 0x0200) != 0)
+		{
+			OutErrorMessage = TEXT("Font license (OS/2 fsType) does not permit embedding");
+			return nullptr;
+		}
+		Font->bNoSubsetting = (EmbeddingFlags & 0x0100) != 0;
+
+		if (ReadU16(Table) >= 2 && OS2.Length >= 90 && ReadS16(Table + 88) > 0)
+		{
+			Font->CapHeight = ReadS16(Table + 88);
+		}
+	}
+
+	FTable Post;
+	if (FindTable(MakeTag('p', 'o', 's', 't'), 16, Post))
+	{
+		Font->ItalicAngle = (int32)ReadU32(Bytes + Post.Offset + 4) / 65536.0f;
+		Font->bFixedPitch = ReadU32(Bytes + Post.Offset + 12) != 0;
+	}
+
+	FTable Name;
+	Font->ParseNames(FindTable(MakeTag('n', 'a', 'm', 'e'), 6, Name) ? Name : FTable());
+
+	if (!Font->ParseCharacterMap(Cmap, OutErrorMessage))
+	{
+		return nullptr;
+	}
+
+	return Font;
+}
+
+bool FPDFTrueTypeFont::ParseCharacterMap(const FTable& Cmap, FString& OutErrorMessage)
+{
+	using namespace PDFFont;
+
+	const uint8* Table = Data.GetData() + Cmap.Offset;
+	const int32 NumSubtables = ReadU16(Table + 2);
+	if (4 + NumSubtables * 8 > Cmap.Length)
+	{
+		OutErrorMessage = TEXT("Font cmap table is truncated");
+		return false;
+	}
+
+	// Prefer the full Unicode map (format 12), then the BMP map (format 4), then a symbol map
+	int32 BestOffset = 0;
+	int32 BestScore = 0;
+	for (int32 Index = 0; Index < NumSubtables; ++Index)
+	{
+		const uint8* Record = Table + 4 + Index * 8;
+		const uint16 Platform = ReadU16(Record);
+		const uint16 Encoding = ReadU16(Record + 2);
+		const uint32 Offset = ReadU32(Record + 4);
+		if ((int64)Offset + 4 > Cmap.Length)
+		{
+			continue;
+		}
+
+		const uint16 Format = ReadU16(Table + Offset);
+		const bool bUnicode = Platform == 0 || (Platform == 3 && (Encoding == 1 || Encoding == 10));
+		const int32 Score = Format == 12 && bUnicode ? 3
+			: Format == 4 && bUnicode ? 2
+			: Format == 4 && Platform == 3 && Encoding == 0 ? 1
+			: 0;
+		if (Score > BestScore)
+		{
+			BestScore = Score;
+			BestOffset = Offset;
+		}
+	}
+
+	if (BestScore == 0)
+	{
+		OutErrorMessage = TEXT("Font has no Unicode character map");
+		return false;
+	}
+
+	const int32 FontGlyphs = NumGlyphs();
+	GlyphToChar.Init(0, FontGlyphs);
+
+	auto AddMapping = [this, FontGlyphs](uint32 CodePoint, uint32 Glyph)
+	{
+		if (Glyph == 0 || Glyph >= (uint32)FontGlyphs)
+		{
+			return;
+		}
+		CharToGlyph.Add(CodePoint, (uint16)Glyph);
+		if (GlyphToChar[Glyph] == 0 || CodePoint < GlyphToChar[Glyph])
+		{
+			GlyphToChar[Glyph] = CodePoint;
+		}
+	};
+
+	const uint8* Subtable = Table + BestOffset;
+	const int64 SubtableLength = Cmap.Length - BestOffset;
+	bool bValid = true;
+
+	if (BestScore == 3)
+	{
+		const int64 NumGroups = SubtableLength >= 16 ? ReadU32(Subtable + 12) : 0;
+		bValid = SubtableLength >= 16 && 16 + NumGroups * 12 <= SubtableLength;
+		for (int64 Group = 0; bValid && Group < NumGroups; ++Group)
+		{
+			const uint8* Entry = Subtable + 16 + Group * 12;
+			const uint32 FirstCode = ReadU32(Entry);
+			const uint32 LastCode = FMath::Min<uint32>(ReadU32(Entry + 4), 0x10FFFF);
+			const uint32 FirstGlyph = ReadU32(Entry + 8);
+			for (uint32 Code = FirstCode; Code <= LastCode && FirstGlyph + (Code - FirstCode) < (uint32)FontGlyphs; ++Code)
+			{
+				AddMapping(Code, FirstGlyph + (Code - FirstCode));
+			}
+		}
+	}
+	else
+	{
+		const int32 NumSegments = SubtableLength >= 14 ? ReadU16(Subtable + 6) / 2 : 0;
+		bValid = SubtableLength >= 14 && 16 + NumSegments * 8 <= SubtableLength;
+		const int32 EndCodes = 14;
+		const int32 StartCodes = 16 + NumSegments * 2;
+		const int32 Deltas = 16 + NumSegments * 4;
+		const int32 RangeOffsets = 16 + NumSegments * 6;
+
+		// Symbol fonts map their characters to U+F000..U+F0FF; text uses the plain 8-bit codes
+		const bool bSymbol = BestScore == 1;
+
+		for (int32 Segment = 0; bValid && Segment < NumSegments; ++Segment)
+		{
+			const uint32 StartCode = ReadU16(Subtable + StartCodes + Segment * 2);
+			const uint32 EndCode = ReadU16(Subtable + EndCodes + Segment * 2);
+			const uint16 Delta = ReadU16(Subtable + Deltas + Segment * 2);
+			const uint16 RangeOffset = ReadU16(Subtable + RangeOffsets + Segment * 2);
+
+			for (uint32 Code = StartCode; Code <= EndCode && Code != 0xFFFF; ++Code)
+			{
+				uint32 Glyph = 0;
+				if (RangeOffset == 0)
+				{
+					Glyph = (Code + Delta) & 0xFFFF;
+				}
+				else
+				{
+					// idRangeOffset is relative to its own position in the subtable
+					const int64 GlyphPos = RangeOffsets + Segment * 2 + RangeOffset + (Code - StartCode) * 2;
+					if (GlyphPos + 2 > SubtableLength)
+					{
+						break;
+					}
+					Glyph = ReadU16(Subtable + GlyphPos);
+					Glyph = Glyph != 0 ? (Glyph + Delta) & 0xFFFF : 0;
+				}
+
+				AddMapping(bSymbol && Code >= 0xF000 && Code <= 0xF0FF ? Code - 0xF000 : Code, Glyph);
+			}
+		}
+	}
+
+	if (!bValid)
+	{
+		OutErrorMessage = TEXT("Font has a corrupt character map");
+		return false;
+	}
+	return true;
+}
+
+void FPDFTrueTypeFont::ParseNames(const FTable& Name)
+{
+	using namespace PDFFont;
+
+	const uint8* Table = Data.GetData() + Name.Offset;
+	const int32 NumRecords = Name.Length >= 6 ? ReadU16(Table + 2) : 0;
+	const int32 StringOffset = Name.Length >= 6 ? ReadU16(Table + 4) : 0;
+
+	for (int32 Index = 0; Index < NumRecords && 6 + (Index + 1) * 12 <= Name.Length; ++Index)
+	{
+		const uint8* Record = Table + 6 + Index * 12;
+		const uint16 Platform = ReadU16(Record);
+		const uint16 NameId = ReadU16(Record + 6);
+		const int32 Length = ReadU16(Record + 8);
+		const int32 Start = StringOffset + ReadU16(Record + 10);
+
+		// Name 6 is the PostScript name: UTF-16BE on the Unicode and Windows platforms, 8-bit on Macintosh
+		if (NameId != 6 || Start + Length > Name.Length || (Platform != 0 && Platform != 1 && Platform != 3))
+		{
+			continue;
+		}
+
+		FString Candidate;
+		const int32 CharSize = Platform == 1 ? 1 : 2;
+		for (int32 Pos = 0; Pos + CharSize <= Length; Pos += CharSize)
+		{
+			const uint32 Char = CharSize == 1 ? Table[Start + Pos] : ReadU16(Table + Start + Pos);
+
+			// Only characters that can appear in a PDF name unescaped
+			if (Char > 32 && Char < 127 && !FCString::Strchr(TEXT("()<>[]{}/%#"), (TCHAR)Char))
+			{
+				Candidate.AppendChar((TCHAR)Char);
+			}
+		}
+
+		if (!Candidate.IsEmpty())
+		{
+			PostScriptName = Candidate.Left(63);
+			if (Platform == 3)
+			{
+				break;
+			}
+		}
+	}
+
+	if (PostScriptName.IsEmpty())
+	{
+		PostScriptName = TEXT("EmbeddedFont");
+	}
+}
+
+uint16 FPDFTrueTypeFont::GetGlyph(uint32 CodePoint) const
+{
+	const uint16* Glyph = CharToGlyph.Find(CodePoint);
+	return Glyph ? *Glyph : 0;
+}
+
+void FPDFTrueTypeFont::AppendGlyphs(const FString& Text, TArray<uint8>& OutHex, TSet<uint16>& OutGlyphs) const
+{
+	OutHex.Reserve(OutHex.Num() + Text.Len() * 4);
+	for (int32 Index = 0; Index < Text.Len(); ++Index)
+	{
+		uint32 CodePoint = (uint32)Text[Index];
+
+		// Characters outside the BMP are surrogate pairs where TCHAR is UTF-16
+		if (CodePoint >= 0xD800 && CodePoint < 0xDC00 && Index + 1 < Text.Len())
+		{
+			const uint32 Low = (uint32)Text[Index + 1];
+			if (Low >= 0xDC00 && Low < 0xE000)
+			{
+				CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Low - 0xDC00);
+				++Index;
+			}
+		}
+
+		const uint16 Glyph = GetGlyph(CodePoint);
+		if (Glyph == 0)
+		{
+			// Pages are serialized in parallel; the lock is only taken for characters the font lacks
+			FScopeLock Lock(&MissingCharactersLock);
+			bool bAlreadyReported = false;
+			MissingCharacters.Add(CodePoint, &bAlreadyReported);
+			if (!bAlreadyReported)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Font %s has no glyph for U+%04X; drawing .notdef instead"), *PostScriptName, CodePoint);
+			}
+		}
+
+		PDFFont::AppendHex(OutHex, Glyph);
+		OutGlyphs.Add(Glyph);
+	}
+}
+
+int32 FPDFTrueTypeFont::ScaleToPDF(int32 FontUnits) const
+{
+	return FMath::RoundToInt(FontUnits * 1000.0f / UnitsPerEm);
+}
+
+TSharedRef<const FPDFFontSubset> FPDFTrueTypeFont::GetSubset(const TSet<uint16>& Glyphs) const
+{
+	TArray<uint16> SortedGlyphs;
+	SortedGlyphs.Reserve(Glyphs.Num());
+	for (const uint16 Glyph : Glyphs)
+	{
+		if (Glyph < NumGlyphs())
+		{
+			SortedGlyphs.Add(Glyph);
+		}
+	}
+	SortedGlyphs.Sort();
+
+	{
+		FScopeLock Lock(&SubsetLock);
+		for (int32 Index = 0; Index < RecentSubsets.Num(); ++Index)
+		{
+			if (RecentSubsets[Index]->Glyphs == SortedGlyphs)
+			{
+				TSharedRef<const FPDFFontSubset> Subset = RecentSubsets[Index];
+				RecentSubsets.RemoveAt(Index);
+				RecentSubsets.Insert(Subset, 0);
+				return Subset;
+			}
+		}
+	}
+
+	// Build outside the lock so documents with different glyphs do not wait on each other
+	TSharedRef<const FPDFFontSubset> Subset = BuildSubset(MoveTemp(SortedGlyphs));
+
+	FScopeLock Lock(&SubsetLock);
+	RecentSubsets.Insert(Subset, 0);
+	if (RecentSubsets.Num() > MaxCachedSubsets)
+	{
+		RecentSubsets.RemoveAt(RecentSubsets.Num() - 1);
+	}
+	return Subset;
+}
+
+void FPDFTrueTypeFont::BuildSubsetProgram(const TArray<uint16>& Glyphs, TArray<uint8>& OutProgram, TArray<uint16>& OutNewToOld) const
+{
+	using namespace PDFFont;
+
+	const int32 FontGlyphs = NumGlyphs();
+	const uint8* GlyphData = Data.GetData() + Glyf.Offset;
+
+	// Glyph 0 (.notdef) must stay first; composite glyphs pull in their components
+	TSet<uint16> Included;
+	TArray<uint16> Pending;
+	Included.Add(0);
+	if (bNoSubsetting)
+	{
+		// The license asks for the complete font; renumbering is then the identity
+		for (int32 Glyph = 1; Glyph < FontGlyphs; ++Glyph)
+		{
+			Included.Add((uint16)Glyph);
+		}
+	}
+	for (const uint16 Glyph : Glyphs)
+	{
+		if (Glyph < FontGlyphs && !Included.Contains(Glyph))
+		{
+			Included.Add(Glyph);
+			Pending.Add(Glyph);
+		}
+	}
+	while (Pending.Num() > 0)
+	{
+		const uint16 Glyph = Pending.Pop();
+		const uint8* Outline = GlyphData + GlyphOffsets[Glyph];
+		ForEachComponent(Outline, GlyphOffsets[Glyph + 1] - GlyphOffsets[Glyph], [&](int32 ComponentOffset)
+		{
+			const uint16 Component = ReadU16(Outline + ComponentOffset);
+			if (Component < FontGlyphs && !Included.Contains(Component))
+			{
+				Included.Add(Component);
+				Pending.Add(Component);
+			}
+		});
+	}
+
+	OutNewToOld = Included.Array();
+	OutNewToOld.Sort();
+
+	TMap<uint16, uint16> OldToNew;
+	OldToNew.Reserve(OutNewToOld.Num());
+	for (int32 NewGlyph = 0; NewGlyph < OutNewToOld.Num(); ++NewGlyph)
+	{
+		OldToNew.Add(OutNewToOld[NewGlyph], (uint16)NewGlyph);
+	}
+
+	// Outlines (renumbering composite components), long offsets and full metrics for every kept glyph
+	TArray<uint8> GlyfTable;
+	TArray<uint8> LocaTable;
+	TArray<uint8> HmtxTable;
+	for (const uint16 OldGlyph : OutNewToOld)
+	{
+		WriteU32(LocaTable, GlyfTable.Num());
+
+		const int32 Start = GlyfTable.Num();
+		const int32 Length = GlyphOffsets[OldGlyph + 1] - GlyphOffsets[OldGlyph];
+		GlyfTable.Append(GlyphData + GlyphOffsets[OldGlyph], Length);
+		ForEachComponent(GlyfTable.GetData() + Start, Length, [&GlyfTable, &OldToNew, Start](int32 ComponentOffset)
+		{
+			uint8* ComponentGlyph = GlyfTable.GetData() + Start + ComponentOffset;
+			SetU16(ComponentGlyph, OldToNew.FindRef(ReadU16(ComponentGlyph)));
+		});
+		PadTo4(GlyfTable);
+
+		WriteU16(HmtxTable, AdvanceWidths[OldGlyph]);
+		WriteU16(HmtxTable, (uint16)LeftSideBearings[OldGlyph]);
+	}
+	WriteU32(LocaTable, GlyfTable.Num());
+
+	auto CopyTable = [this](const FTable& Table)
+	{
+		return TArray<uint8>(Data.GetData() + Table.Offset, Table.Length);
+	};
+
+	TArray<uint8> HeadTable = CopyTable(Head);
+	SetU32(HeadTable.GetData() + 8, 0);
+	SetU16(HeadTable.GetData() + 50, 1);
+
+	TArray<uint8> HheaTable = CopyTable(Hhea);
+	SetU16(HheaTable.GetData() + 34, (uint16)OutNewToOld.Num());
+
+	TArray<uint8> MaxpTable = CopyTable(Maxp);
+	SetU16(MaxpTable.GetData() + 4, (uint16)OutNewToOld.Num());
+
+	// In tag order, as the table directory requires; a CIDFontType2 program needs no cmap
+	TArray<TPair<uint32, TArray<uint8>>> Tables;
+	if (Cvt.Length > 0)
+	{
+		Tables.Emplace(MakeTag('c', 'v', 't', ' '), CopyTable(Cvt));
+	}
+	if (Fpgm.Length > 0)
+	{
+		Tables.Emplace(MakeTag('f', 'p', 'g', 'm'), CopyTable(Fpgm));
+	}
+	Tables.Emplace(MakeTag('g', 'l', 'y', 'f'), MoveTemp(GlyfTable));
+	Tables.Emplace(MakeTag('h', 'e', 'a', 'd'), MoveTemp(HeadTable));
+	Tables.Emplace(MakeTag('h', 'h', 'e', 'a'), MoveTemp(HheaTable));
+	Tables.Emplace(MakeTag('h', 'm', 't', 'x'), MoveTemp(HmtxTable));
+	Tables.Emplace(MakeTag('l', 'o', 'c', 'a'), MoveTemp(LocaTable));
+	Tables.Emplace(MakeTag('m', 'a', 'x', 'p'), MoveTemp(MaxpTable));
+	if (Prep.Length > 0)
+	{
+		Tables.Emplace(MakeTag('p', 'r', 'e', 'p'), CopyTable(Prep));
+	}
+
+	const int32 NumTables = Tables.Num();
+	const int32 EntrySelector = FMath::FloorLog2(NumTables);
+	const int32 SearchRange = (1 << EntrySelector) * 16;
+
+	OutProgram.Reset();
+	WriteU32(OutProgram, 0x00010000);
+	WriteU16(OutProgram, (uint16)NumTables);
+	WriteU16(OutProgram, (uint16)SearchRange);
+	WriteU16(OutProgram, (uint16)EntrySelector);
+	WriteU16(OutProgram, (uint16)(NumTables * 16 - SearchRange));
+
+	int32 TableOffset = 12 + NumTables * 16;
+	int32 HeadOffset = 0;
+	for (const TPair<uint32, TArray<uint8>>& Table : Tables)
+	{
+		HeadOffset = Table.Key == MakeTag('h', 'e', 'a', 'd') ? TableOffset : HeadOffset;
+		WriteU32(OutProgram, Table.Key);
+		WriteU32(OutProgram, CalcChecksum(Table.Value.GetData(), Table.Value.Num()));
+		WriteU32(OutProgram, TableOffset);
+		WriteU32(OutProgram, Table.Value.Num());
+		TableOffset += Align(Table.Value.Num(), 4);
+	}
+	for (const TPair<uint32, TArray<uint8>>& Table : Tables)
+	{
+		OutProgram.Append(Table.Value);
+		PadTo4(OutProgram);
+	}
+
+	// The whole file sums to a fixed magic number
+	SetU32(OutProgram.GetData() + HeadOffset + 8, 0xB1B0AFBA - CalcChecksum(OutProgram.GetData(), OutProgram.Num()));
+}
+
+TSharedRef<const FPDFFontSubset> FPDFTrueTypeFont::BuildSubset(TArray<uint16>&& Glyphs) const
+{
+	using namespace PDFFont;
+
+	TSharedRef<FPDFFontSubset> Subset = MakeShared<FPDFFontSubset>();
+	Subset->Glyphs = MoveTemp(Glyphs);
+	const TArray<uint16>& Drawn = Subset->Glyphs;
+
+	TArray<uint16> NewToOld;
+	BuildSubsetProgram(Drawn, Subset->FontFile.Bytes, NewToOld);
+	const int32 ProgramLength = Subset->FontFile.Bytes.Num();
+	const FString FontFileFilter = CompressedEntries(Subset->FontFile.Bytes);
+	Subset->FontFile.Entries = FString::Printf(TEXT("/Length1 %d"), ProgramLength) + (FontFileFilter.IsEmpty() ? TEXT("") : TEXT(" ")) + FontFileFilter;
+
+	// Six letters derived from the glyph set, so the same subset always gets the same name.
+	// A program holding every glyph is the complete font and is named without a tag.
+	if (bNoSubsetting || NewToOld.Num() == NumGlyphs())
+	{
+		Subset->BaseFont = PostScriptName;
+	}
+	else
+	{
+		uint32 Hash = FCrc::MemCrc32(NewToOld.GetData(), NewToOld.Num() * sizeof(uint16));
+		FString Tag;
+		for (int32 Letter = 0; Letter < 6; ++Letter)
+		{
+			Tag.AppendChar((TCHAR)(TEXT('A') + Hash % 26));
+			Hash /= 26;
+		}
+		Subset->BaseFont = Tag + TEXT("+") + PostScriptName;
+	}
+
+	// Symbolic: glyphs are addressed by id, not through a standard Latin encoding
+	const int32 Flags = 4 | (bFixedPitch ? 1 : 0) | (ItalicAngle != 0.0f ? 64 : 0);
+	Subset->DescriptorEntries = FString::Printf(TEXT("/Flags %d /FontBBox [%d %d %d %d] /ItalicAngle %s /Ascent %d /Descent %d /CapHeight %d /StemV 80"),
+		Flags, ScaleToPDF(XMin), ScaleToPDF(YMin), ScaleToPDF(XMax), ScaleToPDF(YMax),
+		*FString::SanitizeFloat(ItalicAngle, 0), ScaleToPDF(Ascent), ScaleToPDF(Descent), ScaleToPDF(CapHeight));
+
+	// Widths of the drawn glyphs, one array per run of consecutive ids
+	for (int32 RunStart = 0; RunStart < Drawn.Num();)
+	{
+		int32 RunEnd = RunStart + 1;
+		while (RunEnd < Drawn.Num() && Drawn[RunEnd] == Drawn[RunEnd - 1] + 1)
+		{
+			++RunEnd;
+		}
+
+		Subset->Widths += FString::Printf(TEXT("%s%d ["), Subset->Widths.IsEmpty() ? TEXT("") : TEXT(" "), Drawn[RunStart]);
+		for (int32 Index = RunStart; Index < RunEnd; ++Index)
+		{
+			Subset->Widths += FString::Printf(TEXT("%s%d"), Index == RunStart ? TEXT("") : TEXT(" "), ScaleToPDF(AdvanceWidths[Drawn[Index]]));
+		}
+		Subset->Widths += TEXT("]");
+		RunStart = RunEnd;
+	}
+
+	// CID (original glyph id) -> glyph id in the subset, two bytes each
+	const int32 MaxCID = Drawn.Num() > 0 ? Drawn.Last() : 0;
+	TArray<uint8>& CIDToGIDMap = Subset->CIDToGIDMap.Bytes;
+	CIDToGIDMap.SetNumZeroed((MaxCID + 1) * 2);
+	for (int32 NewGlyph = 0; NewGlyph < NewToOld.Num(); ++NewGlyph)
+	{
+		if (NewToOld[NewGlyph] <= MaxCID)
+		{
+			SetU16(CIDToGIDMap.GetData() + NewToOld[NewGlyph] * 2, (uint16)NewGlyph);
+		}
+	}
+	Subset->CIDToGIDMap.Entries = CompressedEntries(CIDToGIDMap);
+
+	// ToUnicode lets viewers copy and search the text
+	TArray<uint16> Mapped;
+	for (const uint16 Glyph : Drawn)
+	{
+		if (GlyphToChar[Glyph] != 0)
+		{
+			Mapped.Add(Glyph);
+		}
+	}
+
+	FString CMap = TEXT("/CIDInit /ProcSet findresource begin\n12 dict begin\nbegincmap\n")
+		TEXT("/CIDSystemInfo << /Registry (Adobe) /Ordering (UCS) /Supplement 0 >> def\n")
+		TEXT("/CMapName /Adobe-Identity-UCS def\n/CMapType 2 def\n")
+		TEXT("1 begincodespacerange\n<0000> <FFFF>\nendcodespacerange\n");
+	for (int32 ChunkStart = 0; ChunkStart < Mapped.Num(); ChunkStart += 100)
+	{
+		// At most 100 entries per bfchar block
+		const int32 ChunkEnd = FMath::Min(ChunkStart + 100, Mapped.Num());
+		CMap += FString::Printf(TEXT("%d beginbfchar\n"), ChunkEnd - ChunkStart);
+		for (int32 Index = ChunkStart; Index < ChunkEnd; ++Index)
+		{
+			CMap += FString::Printf(TEXT("<%04X> <%s>\n"), Mapped[Index], *UTF16Hex(GlyphToChar[Mapped[Index]]));
+		}
+		CMap += TEXT("endbfchar\n");
+	}
+	CMap += TEXT("endcmap\nCMapName currentdict /CMap defineresource pop\nend\nend\n");
+
+	FTCHARToUTF8 CMapUTF8(*CMap);
+	Subset->ToUnicode.Bytes.Append((const uint8*)CMapUTF8.Get(), CMapUTF8.Length());
+	Subset->ToUnicode.Entries = CompressedEntries(Subset->ToUnicode.Bytes);
+
+	return Subset;
+}
+
+TSharedPtr<const FPDFTrueTypeFont> FPDFFontCache::Load(const FString& FilePath, FString& OutErrorMessage)
+{
+	const FDateTime Timestamp = IFileManager::Get().GetTimeStamp(*FilePath);
+	if (Timestamp == FDateTime::MinValue())
+	{
+		OutErrorMessage = FString::Printf(TEXT("Font file not found: %s"), *FilePath);
+		return nullptr;
+	}
+
+	PDFFont::FCache& Cache = PDFFont::GetCache();
+	{
+		FScopeLock Lock(&Cache.Lock);
+		const PDFFont::FCachedFont* Cached = Cache.Fonts.Find(FilePath);
+		if (Cached && Cached->Timestamp == Timestamp)
+		{
+			return Cached->Font;
+		}
+	}
+
+	// Parse outside the lock so loading a large font does not hold up other fonts
+	TArray<uint8> FileBytes;
+	if (!FFileHelper::LoadFileToArray(FileBytes, *FilePath))
+	{
+		OutErrorMessage = FString::Printf(TEXT("Failed to read font: %s"), *FilePath);
+		return nullptr;
+	}
+
+	TSharedPtr<const FPDFTrueTypeFont> Font = FPDFTrueTypeFont::Parse(MoveTemp(FileBytes), OutErrorMessage);
+	if (!Font.IsValid())
+	{
+		OutErrorMessage = FString::Printf(TEXT("%s: %s"), *OutErrorMessage, *FilePath);
+		return nullptr;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Loaded font %s (%s, %d glyphs, %d characters)"),
+		*FilePath, *Font->GetPostScriptName(), Font->NumGlyphs(), Font->NumMappedCharacters());
+
+	FScopeLock Lock(&Cache.Lock);
+	PDFFont::FCachedFont& Entry = Cache.Fonts.FindOrAdd(FilePath);
+	Entry.Timestamp = Timestamp;
+	Entry.Font = Font;
+	return Font;
+}
+
+void FPDFFontCache::Empty()
+{
+	PDFFont::FCache& Cache = PDFFont::GetCache();
+	FScopeLock Lock(&Cache.Lock);
+	Cache.Fonts.Empty();
+}
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * PDF.TestFontSubset FontPath [Text]
+ * Subsets a TrueType font to the glyphs of some text and checks the result:
+ * the subset program must carry a valid whole-file checksum, and asking for the
+ * same glyphs again must return the cached subset.
+ */
+static FAutoConsoleCommand GTestFontSubsetCommand(
+	TEXT("PDF.TestFontSubset"),
+	TEXT("Subset a TrueType font to the glyphs of some text and validate the result. Usage: PDF.TestFontSubset FontPath [Text]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() == 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("PDF.TestFontSubset: no font path given"));
+			return;
+		}
+
+		const FString FontPath = FPaths::IsRelative(Args[0]) ? FPaths::ProjectContentDir() / Args[0] : Args[0];
+		FString ErrorMessage;
+		TSharedPtr<const FPDFTrueTypeFont> Font = FPDFFontCache::Load(FontPath, ErrorMessage);
+		if (!Font.IsValid())
+		{
+			UE_LOG(LogTemp, Error, TEXT("PDF.TestFontSubset: %s"), *ErrorMessage);
+			return;
+		}
+
+		FString Text;
+		for (int32 Index = 1; Index < Args.Num(); ++Index)
+		{
+			Text += (Text.IsEmpty() ? TEXT("") : TEXT(" ")) + Args[Index];
+		}
+		if (Text.IsEmpty())
+		{
+			Text = TEXT("Product Configuration Summary 0123456789 Gr\u00FC\u00DFe \u00D1and\u00FA \u20AC");
+		}
+
+		TArray<uint8> Hex;
+		TSet<uint16> Glyphs;
+		Font->AppendGlyphs(Text, Hex, Glyphs);
+
+		const double StartTime = FPlatformTime::Seconds();
+		TSharedRef<const FPDFFontSubset> Subset = Font->GetSubset(Glyphs);
+		const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		const bool bCached = &Font->GetSubset(Glyphs).Get() == &Subset.Get();
+
+		TArray<uint8> Program;
+		TArray<uint16> NewToOld;
+		Font->BuildSubsetProgram(Subset->Glyphs, Program, NewToOld);
+
+		uint32 Checksum = 0;
+		for (int32 Index = 0; Index + 4 <= Program.Num(); Index += 4)
+		{
+			Checksum += PDFFont::ReadU32(Program.GetData() + Index);
+		}
+		const bool bChecksumValid = Program.Num() % 4 == 0 && Checksum == 0xB1B0AFBA;
+
+		UE_LOG(LogTemp, Display, TEXT("PDF.TestFontSubset: %s, %d of %d glyphs (%d with components), %d byte program, %d bytes in the PDF, %.2f ms; checksum %s, cache %s"),
+			*Subset->BaseFont, Subset->Glyphs.Num(), Font->NumGlyphs(), NewToOld.Num(), Program.Num(),
+			Subset->FontFile.Bytes.Num() + Subset->CIDToGIDMap.Bytes.Num() + Subset->ToUnicode.Bytes.Num(), ElapsedMs,
+			bChecksumValid ? TEXT("valid") : TEXT("INVALID"), bCached ? TEXT("hit") : TEXT("MISS"));
+	}));
+
+#endif
@@ -1,158 +1,313 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "PDFGenerator.h"
+#include "PDFLayoutTemplate.h"
+#include "PDFFont.h"
+#include "PDFObjectWriter.h"
+#include "PDFDocument.h"
+#include "PDFLinearizer.h"
+#include "PDFOutputSink.h"
+#include "PDFCatalogWriter.h"
+#include "PDFIncrementalUpdate.h"
+#include "PDFParsing.h"
+#include "ConfigurationExportLibrary.h"
 #include "Misc/FileHelper.h"
 #include "HAL/PlatformFileManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
 #include "Dom/JsonObject.h"
+#include "JsonObjectConverter.h"
 #include "Misc/Paths.h"
+#include "Misc/Compression.h"
+#include "Math/RandomStream.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
 
-FString FPDFGenerator::EscapePDFString(const FString& Input)
+namespace PDFGenerator
 {
-	// Escape special PDF characters: backslash, parentheses
-	FString Result = Input;
-	Result.ReplaceInline(TEXT("\\"), TEXT("\\\\"));
-	Result.ReplaceInline(TEXT("("), TEXT("\\("));
-	Result.ReplaceInline(TEXT(")"), TEXT("\\)"));
-	return Result;
+	// Below this many pages the task overhead outweighs the gain
+	static constexpr int32 MinPagesForParallel = 4;
+
+	static FString GetImageResourceName(int32 ImageIndex)
+	{
+		return FString::Printf(TEXT("Im%d"), ImageIndex + 1);
+	}
 }
 
-FString FPDFGenerator::BuildPDFContentStream(
-	const FString& ConfigName,
-	const FString& Timestamp,
-	const TArray<FString>& Variants,
-	const FString& Environment,
-	const FString& Camera)
+bool FPDFGenerator::CompressStream(TArray<uint8>& InOutStream)
 {
-	TArray<FString> Lines;
-	
-	// Begin text block
-	Lines.Add(TEXT("BT"));
-	
-	// Title: Product Configuration Summary (Bold, 16pt)
-	Lines.Add(TEXT("/F2 16 Tf"));
-	Lines.Add(TEXT("50 750 Td"));
-	Lines.Add(FString::Printf(TEXT("(%s) Tj"), *EscapePDFString(TEXT("Product Configuration Summary"))));
-	
-	// Configuration name (Regular, 11pt)
-	Lines.Add(TEXT("0 -25 Td /F1 11 Tf"));
-	Lines.Add(FString::Printf(TEXT("(Configuration: %s) Tj"), *EscapePDFString(ConfigName)));
-	
-	// Timestamp
-	Lines.Add(TEXT("0 -18 Td"));
-	Lines.Add(FString::Printf(TEXT("(Timestamp: %s) Tj"), *EscapePDFString(Timestamp)));
-	
-	// Selected Variants header (Bold, 12pt)
-	Lines.Add(TEXT("0 -30 Td /F2 12 Tf"));
-	Lines.Add(TEXT("(Selected Variants:) Tj"));
-	
-	// Variant list (Regular, 10pt)
-	Lines.Add(TEXT("0 -20 Td /F1 10 Tf"));
-	
-	// List variants (max 30)
-	int32 MaxVariants = FMath::Min(Variants.Num(), 30);
-	for (int32 i = 0; i < MaxVariants; ++i)
+	// zlib format (header + deflate + adler32) is exactly what /FlateDecode expects
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, InOutStream.Num());
+	TArray<uint8> Compressed;
+	Compressed.SetNumUninitialized(CompressedSize);
+
+	if (!FCompression::CompressMemory(NAME_Zlib, Compressed.GetData(), CompressedSize, InOutStream.GetData(), InOutStream.Num()))
 	{
-		FString VariantLine = FString::Printf(TEXT("  %d. %s"), i + 1, *EscapePDFString(Variants[i]));
-		Lines.Add(FString::Printf(TEXT("(%s) Tj 0 -14 Td"), *VariantLine));
+		return false;
 	}
-	
-	// If more than 30 variants, show ellipsis
-	if (Variants.Num() > 30)
+
+	Compressed.SetNum(CompressedSize, EAllowShrinking::No);
+	InOutStream = MoveTemp(Compressed);
+	return true;
+}
+
+void FPDFGenerator::SerializePages(
+	const FConfigurationData& ConfigData,
+	const FPDFLayoutProgram& Layout,
+	const TArray<FPDFLayoutPage>& Pages,
+	const FPDFDocumentImages& Images,
+	const FPDFWriteOptions& Options,
+	TArray<FPDFPageStream>& OutPageStreams)
+{
+	OutPageStreams.Reset();
+	OutPageStreams.SetNum(Pages.Num());
+
+	// Each page writes only its own buffer, so pages can be produced in any order
+	auto SerializePage = [&ConfigData, &Layout, &Pages, &Images, &Options, &OutPageStreams](int32 PageIndex)
 	{
-		FString MoreText = FString::Printf(TEXT("  ... and %d more"), Variants.Num() - 30);
-		Lines.Add(FString::Printf(TEXT("(%s) Tj 0 -14 Td"), *MoreText));
+		FPDFPageStream& PageStream = OutPageStreams[PageIndex];
+		Layout.SerializePage(ConfigData, Pages[PageIndex], Images.ByPath, PageStream.Bytes, PageStream.Glyphs);
+		if (Options.bCompressStreams)
+		{
+			PageStream.bCompressed = CompressStream(PageStream.Bytes);
+		}
+	};
+
+	const int32 MaxThreads = Options.MaxThreads > 0 ? Options.MaxThreads : FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+	const int32 NumTasks = FMath::Min(MaxThreads, Pages.Num());
+
+	if (NumTasks <= 1 || Pages.Num() < PDFGenerator::MinPagesForParallel)
+	{
+		for (int32 PageIndex = 0; PageIndex < Pages.Num(); ++PageIndex)
+		{
+			SerializePage(PageIndex);
+		}
+		return;
 	}
-	
-	// Environment (Bold, 11pt)
-	Lines.Add(TEXT("0 -20 Td /F2 11 Tf"));
-	Lines.Add(FString::Printf(TEXT("(Environment: %s) Tj"), *EscapePDFString(Environment)));
-	
-	// Camera
-	Lines.Add(TEXT("0 -18 Td"));
-	Lines.Add(FString::Printf(TEXT("(Camera: %s) Tj"), *EscapePDFString(Camera)));
-	
-	// End text block
-	Lines.Add(TEXT("ET"));
-	
-	// Join with newlines
-	return FString::Join(Lines, TEXT("\n"));
+
+	// One task per contiguous block of pages caps concurrency at NumTasks
+	const int32 PagesPerTask = FMath::DivideAndRoundUp(Pages.Num(), NumTasks);
+	ParallelFor(NumTasks, [&Pages, &SerializePage, PagesPerTask](int32 TaskIndex)
+	{
+		const int32 FirstPage = TaskIndex * PagesPerTask;
+		const int32 LastPage = FMath::Min(FirstPage + PagesPerTask, Pages.Num());
+		for (int32 PageIndex = FirstPage; PageIndex < LastPage; ++PageIndex)
+		{
+			SerializePage(PageIndex);
+		}
+	});
 }
 
-TArray<uint8> FPDFGenerator::BuildPDFDocument(const FString& ContentStream)
+void FPDFGenerator::ResolveImages(const FConfigurationData& ConfigData, const FPDFLayoutProgram& Layout, FPDFDocumentImages& OutImages)
 {
-	// Convert content stream to Latin-1 (PDF standard encoding)
-	FTCHARToUTF8 ContentUTF8(*ContentStream);
-	int32 StreamLength = ContentUTF8.Length();
-	
-	TArray<FString> PDFLines;
-	
-	// PDF Header
-	PDFLines.Add(TEXT("%PDF-1.4"));
-	
-	// Object 1: Catalog
-	PDFLines.Add(TEXT("1 0 obj"));
-	PDFLines.Add(TEXT("<< /Type /Catalog /Pages 2 0 R >>"));
-	PDFLines.Add(TEXT("endobj"));
-	
-	// Object 2: Pages collection
-	PDFLines.Add(TEXT("2 0 obj"));
-	PDFLines.Add(TEXT("<< /Type /Pages /Kids [3 0 R] /Count 1 >>"));
-	PDFLines.Add(TEXT("endobj"));
-	
-	// Object 3: Single page (8.5" x 11" = 612 x 792 points)
-	PDFLines.Add(TEXT("3 0 obj"));
-	PDFLines.Add(TEXT("<<"));
-	PDFLines.Add(TEXT("/Type /Page"));
-	PDFLines.Add(TEXT("/Parent 2 0 R"));
-	PDFLines.Add(TEXT("/MediaBox [0 0 612 792]"));
-	PDFLines.Add(TEXT("/Contents 4 0 R"));
-	PDFLines.Add(TEXT("/Resources <<"));
-	PDFLines.Add(TEXT("/Font <<"));
-	PDFLines.Add(TEXT("/F1 << /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>"));
-	PDFLines.Add(TEXT("/F2 << /Type /Font /Subtype /Type1 /BaseFont /Helvetica-Bold >>"));
-	PDFLines.Add(TEXT(">>"));
-	PDFLines.Add(TEXT(">>"));
-	PDFLines.Add(TEXT(">>"));
-	PDFLines.Add(TEXT("endobj"));
-	
-	// Object 4: Content stream
-	PDFLines.Add(TEXT("4 0 obj"));
-	PDFLines.Add(FString::Printf(TEXT("<< /Length %d >>"), StreamLength));
-	PDFLines.Add(TEXT("stream"));
-	PDFLines.Add(ContentStream);
-	PDFLines.Add(TEXT("endstream"));
-	PDFLines.Add(TEXT("endobj"));
-	
-	// Cross-reference table (simplified with fixed offsets)
-	PDFLines.Add(TEXT("xref"));
-	PDFLines.Add(TEXT("0 5"));
-	PDFLines.Add(TEXT("0000000000 65535 f"));
-	PDFLines.Add(TEXT("0000000009 00000 n"));
-	PDFLines.Add(TEXT("0000000058 00000 n"));
-	PDFLines.Add(TEXT("0000000115 00000 n"));
-	PDFLines.Add(TEXT("0000000344 00000 n"));
-	
-	// Trailer
-	PDFLines.Add(TEXT("trailer"));
-	PDFLines.Add(TEXT("<< /Size 5 /Root 1 0 R >>"));
-	PDFLines.Add(TEXT("startxref"));
-	PDFLines.Add(FString::Printf(TEXT("%d"), 400 + StreamLength));
-	PDFLines.Add(TEXT("%%EOF"));
-	
-	// Join all lines
-	FString PDFContent = FString::Join(PDFLines, TEXT("\n"));
-	
-	// Convert to byte array (Latin-1 encoding)
-	FTCHARToUTF8 ContentConverter(*PDFContent);
+	OutImages = FPDFDocumentImages();
+
+	TArray<FString> Paths;
+	Layout.CollectImagePaths(ConfigData, Paths);
+
+	for (const FString& Path : Paths)
+	{
+		const FString FullPath = FPaths::IsRelative(Path) ? FPaths::ProjectContentDir() / Path : Path;
+
+		FString ErrorMessage;
+		TSharedPtr<const FPDFImage> Image = FPDFImageCache::Load(FullPath, ErrorMessage);
+		if (!Image.IsValid())
+		{
+			// A missing picture should not cost the customer their summary
+			UE_LOG(LogTemp, Warning, TEXT("Leaving image out of PDF: %s"), *ErrorMessage);
+			continue;
+		}
+
+		int32 ImageIndex = OutImages.Images.Find(Image);
+		if (ImageIndex == INDEX_NONE)
+		{
+			ImageIndex = OutImages.Images.Add(Image);
+			OutImages.Paths.Add(Path);
+		}
+
+		FPDFLayoutImage& LayoutImage = OutImages.ByPath.Add(Path);
+		LayoutImage.ResourceName = PDFGenerator::GetImageResourceName(ImageIndex);
+		LayoutImage.Width = Image->Width;
+		LayoutImage.Height = Image->Height;
+	}
+}
+
+void FPDFGenerator::BuildDocumentModel(const FPDFLayoutProgram& Layout, const FPDFDocumentImages& Images, TArray<FPDFPageStream>&& PageStreams, FPDFDocument& OutDocument)
+{
+	OutDocument.Catalog = OutDocument.ReserveObject();
+	const int32 PageTree = OutDocument.ReserveObject();
+	const int32 Resources = OutDocument.ReserveObject();
+	OutDocument.SharedObjects.Add(Resources);
+
+	// Keys keep object numbers stable across revisions appended by AppendPDFRevision
+	OutDocument.GetObject(OutDocument.Catalog).Key = TEXT("Catalog");
+	OutDocument.GetObject(PageTree).Key = TEXT("Pages");
+	OutDocument.GetObject(Resources).Key = TEXT("Resources");
+
+	// Fonts, shared by every page through one resource dictionary; embedded fonts carry only the glyphs the pages draw
+	FPDFGlyphUsage UsedGlyphs;
+	for (const FPDFPageStream& PageStream : PageStreams)
+	{
+		UsedGlyphs.Append(PageStream.Glyphs);
+	}
+
+	const TArray<FPDFLayoutFont>& Fonts = Layout.GetFonts();
+	FString FontResources;
+	for (int32 FontIndex = 0; FontIndex < Fonts.Num(); ++FontIndex)
+	{
+		const FPDFLayoutFont& Font = Fonts[FontIndex];
+		int32 FontObject = INDEX_NONE;
+		if (Font.TrueType.IsValid())
+		{
+			const TSet<uint16> NoGlyphs;
+			const TSet<uint16>& Glyphs = UsedGlyphs.Fonts.IsValidIndex(FontIndex) ? UsedGlyphs.Fonts[FontIndex] : NoGlyphs;
+			FontObject = Font.TrueType->GetSubset(Glyphs)->AddToDocument(OutDocument, OutDocument.SharedObjects, TEXT("Font/") + Font.ResourceName);
+		}
+		else
+		{
+			FontObject = OutDocument.AddObject(FString::Printf(TEXT("<< /Type /Font /Subtype /Type1 /BaseFont /%s >>"), *Font.BaseFont));
+			OutDocument.GetObject(FontObject).Key = TEXT("Font/") + Font.ResourceName;
+			OutDocument.SharedObjects.Add(FontObject);
+		}
+		FontResources += FString::Printf(TEXT(" /%s %s"), *Font.ResourceName, *FPDFDocument::Ref(FontObject));
+	}
+
+	// Image XObjects (and their soft masks), shared the same way; the encoded bytes come from FPDFImageCache
+	FString ImageResources;
+	for (int32 ImageIndex = 0; ImageIndex < Images.Images.Num(); ++ImageIndex)
+	{
+		const FPDFImage& Image = *Images.Images[ImageIndex];
+		const FString ImageKey = TEXT("Image/") + (Images.Paths.IsValidIndex(ImageIndex) ? Images.Paths[ImageIndex] : FString());
+
+		FString ImageEntries = Image.GetStreamEntries();
+		if (Image.AlphaData.Num() > 0)
+		{
+			const int32 MaskObject = OutDocument.AddStreamObject(Image.GetAlphaStreamEntries(), TArray<uint8>(Image.AlphaData));
+			OutDocument.GetObject(MaskObject).Key = ImageKey + TEXT("/SMask");
+			OutDocument.SharedObjects.Add(MaskObject);
+			ImageEntries += FString::Printf(TEXT(" /SMask %s"), *FPDFDocument::Ref(MaskObject));
+		}
+
+		const int32 ImageObject = OutDocument.AddStreamObject(ImageEntries, TArray<uint8>(Image.Data));
+		OutDocument.GetObject(ImageObject).Key = ImageKey;
+		OutDocument.SharedObjects.Add(ImageObject);
+		ImageResources += FString::Printf(TEXT(" /%s %s"), *PDFGenerator::GetImageResourceName(ImageIndex), *FPDFDocument::Ref(ImageObject));
+	}
+
+	OutDocument.GetObject(Resources).Body = ImageResources.IsEmpty()
+		? FString::Printf(TEXT("<< /Font <<%s >> >>"), *FontResources)
+		: FString::Printf(TEXT("<< /Font <<%s >> /XObject <<%s >> >>"), *FontResources, *ImageResources);
+
+	const FString MediaBox = FString::Printf(TEXT("[0 0 %s %s]"),
+		*FString::SanitizeFloat(Layout.GetPageWidth(), 0), *FString::SanitizeFloat(Layout.GetPageHeight(), 0));
+
+	// Page objects and their content streams (moved, not copied)
+	FString Kids;
+	for (FPDFPageStream& PageStream : PageStreams)
+	{
+		const int32 PageObject = OutDocument.ReserveObject();
+		const int32 ContentObject = OutDocument.AddStreamObject(PageStream.bCompressed ? TEXT("/Filter /FlateDecode") : FString(), MoveTemp(PageStream.Bytes));
+		OutDocument.GetObject(PageObject).Key = FString::Printf(TEXT("Page/%d"), OutDocument.Pages.Num());
+		OutDocument.GetObject(ContentObject).Key = FString::Printf(TEXT("Page/%d/Contents"), OutDocument.Pages.Num());
+
+		OutDocument.GetObject(PageObject).Body = FString::Printf(
+			TEXT("<< /Type /Page /Parent %s /MediaBox %s /Contents %s /Resources %s >>"),
+			*FPDFDocument::Ref(PageTree), *MediaBox, *FPDFDocument::Ref(ContentObject), *FPDFDocument::Ref(Resources));
+
+		OutDocument.Pages.Add(PageObject);
+		OutDocument.PageContents.Add(ContentObject);
+		Kids += (Kids.IsEmpty() ? TEXT("") : TEXT(" ")) + FPDFDocument::Ref(PageObject);
+	}
+
+	OutDocument.GetObject(PageTree).Body = FString::Printf(TEXT("<< /Type /Pages /Kids [%s] /Count %d >>"), *Kids, PageStreams.Num());
+	OutDocument.GetObject(OutDocument.Catalog).Body = FString::Printf(TEXT("<< /Type /Catalog /Pages %s >>"), *FPDFDocument::Ref(PageTree));
+}
+
+void FPDFGenerator::BuildDocument(const FConfigurationData& ConfigData, const FPDFLayoutProgram& Layout, const FPDFWriteOptions& Options, FPDFDocument& OutDocument)
+{
+	// Lay out the document, then serialize each page's content stream
+	TArray<FPDFLayoutPage> Pages;
+	Layout.Paginate(ConfigData, Pages);
+
+	FPDFDocumentImages Images;
+	ResolveImages(ConfigData, Layout, Images);
+
+	TArray<FPDFPageStream> PageStreams;
+	SerializePages(ConfigData, Layout, Pages, Images, Options, PageStreams);
+
+	BuildDocumentModel(Layout, Images, MoveTemp(PageStreams), OutDocument);
+}
+
+TArray<uint8> FPDFGenerator::BuildPDFDocument(const FConfigurationData& ConfigData, const FPDFLayoutProgram& Layout, const FPDFWriteOptions& Options)
+{
+	FPDFDocument Document;
+	BuildDocument(ConfigData, Layout, Options, Document);
+
+	int64 TotalStreamBytes = 0;
+	for (int32 Id = 1; Id <= Document.NumObjects(); ++Id)
+	{
+		TotalStreamBytes += Document.GetObject(Id).Stream.Num();
+	}
+
 	TArray<uint8> PDFBytes;
-	PDFBytes.Append((uint8*)ContentConverter.Get(), ContentConverter.Length());
-	
+	PDFBytes.Reserve(TotalStreamBytes + 1024 + Document.NumObjects() * 128);
+
+	if (Options.bLinearize)
+	{
+		FPDFLinearizer::Write(Document, PDFBytes);
+	}
+	else
+	{
+		// Stitch everything together sequentially; the writer records object offsets as it goes
+		FPDFObjectWriter Writer(PDFBytes);
+		Writer.WriteHeader();
+		Document.Write(Writer);
+	}
+
 	return PDFBytes;
 }
 
-bool FPDFGenerator::GeneratePDFFromJSON(const FString& JsonFilePath, const FString& PdfFilePath, FString& OutErrorMessage)
+bool FPDFGenerator::GenerateCatalogFromJSON(const TArray<FString>& JsonFilePaths, const FString& PdfFilePath, int32& OutNumConfigurations, FString& OutErrorMessage, const FPDFWriteOptions& Options)
+{
+	OutNumConfigurations = 0;
+	OutErrorMessage.Empty();
+
+	FPDFCatalogWriter Catalog(FPDFLayoutTemplateCache::Get(), Options);
+	if (!Catalog.Open(PdfFilePath, OutErrorMessage))
+	{
+		return false;
+	}
+
+	for (const FString& JsonFilePath : JsonFilePaths)
+	{
+		FConfigurationData ConfigData;
+		FString LoadErrorMessage;
+		if (!LoadConfigurationFromJSON(JsonFilePath, ConfigData, LoadErrorMessage))
+		{
+			// One damaged file should not cost the dealer the whole catalog
+			UE_LOG(LogTemp, Warning, TEXT("Leaving %s out of catalog: %s"), *JsonFilePath, *LoadErrorMessage);
+			continue;
+		}
+
+		if (!Catalog.AddConfiguration(ConfigData, OutErrorMessage))
+		{
+			return false;
+		}
+	}
+
+	if (!Catalog.Finish(OutErrorMessage))
+	{
+		return false;
+	}
+
+	OutNumConfigurations = Catalog.NumConfigurations();
+	return true;
+}
+
+bool FPDFGenerator::LoadConfigurationFromJSON(const FString& JsonFilePath, FConfigurationData& OutConfigData, FString& OutErrorMessage)
 {
 	OutErrorMessage.Empty();
 	
@@ -182,51 +337,453 @@ bool FPDFGenerator::GeneratePDFFromJSON(const FString& JsonFilePath, const FStri
 		return false;
 	}
 	
-	// Extract data from JSON
-	FString ConfigName = JsonObject->GetStringField(TEXT("ConfigurationName"));
-	FString Timestamp = JsonObject->GetStringField(TEXT("Timestamp"));
-	FString Environment = JsonObject->GetStringField(TEXT("SelectedEnvironment"));
-	FString Camera = JsonObject->GetStringField(TEXT("SelectedCamera"));
-	
-	// Extract variants array
-	TArray<FString> Variants;
-	const TArray<TSharedPtr<FJsonValue>>* VariantsArray;
-	if (JsonObject->TryGetArrayField(TEXT("SelectedVariants"), VariantsArray))
+	// Field names match FConfigurationData (missing fields such as ShareCode stay empty)
+	OutConfigData = FConfigurationData();
+	if (!FJsonObjectConverter::JsonObjectToUStruct(JsonObject.ToSharedRef(), &OutConfigData))
 	{
-		for (const TSharedPtr<FJsonValue>& VariantValue : *VariantsArray)
-		{
-			FString VariantString;
-			if (VariantValue->TryGetString(VariantString))
-			{
-				Variants.Add(VariantString);
-			}
-		}
+		OutErrorMessage = TEXT("JSON file does not match the configuration format");
+		return false;
 	}
 	
-	// Build PDF content stream
-	FString ContentStream = BuildPDFContentStream(ConfigName, Timestamp, Variants, Environment, Camera);
+	return true;
+}
+
+bool FPDFGenerator::GeneratePDF(const FConfigurationData& ConfigData, IPDFOutputSink& Sink, FString& OutErrorMessage, const FPDFWriteOptions& Options)
+{
+	OutErrorMessage.Empty();
 	
-	// Build complete PDF document
-	TArray<uint8> PDFBytes = BuildPDFDocument(ContentStream);
+	// Build complete PDF document from the current layout template
+	TArray<uint8> PDFBytes = BuildPDFDocument(ConfigData, *FPDFLayoutTemplateCache::Get(), Options);
 	
-	// Ensure output directory exists
-	FString PDFDirectory = FPaths::GetPath(PdfFilePath);
-	if (!PlatformFile.DirectoryExists(*PDFDirectory))
+	// Hand the buffer over; memory sinks take it without copying
+	if (!Sink.Write(MoveTemp(PDFBytes), OutErrorMessage))
 	{
-		if (!PlatformFile.CreateDirectoryTree(*PDFDirectory))
+		return false;
+	}
+	
+	UE_LOG(LogTemp, Log, TEXT("PDF generated successfully: %s"), *Sink.Describe());
+	return true;
+}
+
+bool FPDFGenerator::GeneratePDF(const FConfigurationData& ConfigData, const FString& PdfFilePath, FString& OutErrorMessage, const FPDFWriteOptions& Options)
+{
+	FPDFFileSink Sink(PdfFilePath);
+	return GeneratePDF(ConfigData, Sink, OutErrorMessage, Options);
+}
+
+bool FPDFGenerator::GeneratePDFFromJSON(const FString& JsonFilePath, IPDFOutputSink& Sink, FString& OutErrorMessage, const FPDFWriteOptions& Options)
+{
+	FConfigurationData ConfigData;
+	if (!LoadConfigurationFromJSON(JsonFilePath, ConfigData, OutErrorMessage))
+	{
+		return false;
+	}
+	
+	return GeneratePDF(ConfigData, Sink, OutErrorMessage, Options);
+}
+
+bool FPDFGenerator::GeneratePDFFromJSON(const FString& JsonFilePath, const FString& PdfFilePath, FString& OutErrorMessage, const FPDFWriteOptions& Options)
+{
+	FPDFFileSink Sink(PdfFilePath);
+	return GeneratePDFFromJSON(JsonFilePath, Sink, OutErrorMessage, Options);
+}
+
+bool FPDFGenerator::AppendPDFRevision(const FConfigurationData& ConfigData, const FString& PdfFilePath, int32& OutNumObjectsWritten, FString& OutErrorMessage, const FPDFWriteOptions& Options)
+{
+	OutNumObjectsWritten = 0;
+	OutErrorMessage.Empty();
+
+	// Revisions are matched by object key, so every revision uses the plain (non-linearized) layout
+	FPDFDocument Document;
+	BuildDocument(ConfigData, *FPDFLayoutTemplateCache::Get(), Options, Document);
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*PdfFilePath))
+	{
+		// The first revision is a complete file, written with the manifest later revisions read
+		TArray<uint8> PDFBytes;
+		if (!FPDFIncrementalUpdate::Build(0, [](int64, int64, TArray<uint8>&) { return false; }, Document, PDFBytes, OutNumObjectsWritten, OutErrorMessage))
 		{
-			OutErrorMessage = FString::Printf(TEXT("Failed to create directory: %s"), *PDFDirectory);
+			OutErrorMessage = FString::Printf(TEXT("Cannot create %s: %s"), *PdfFilePath, *OutErrorMessage);
 			return false;
 		}
+
+		FPDFFileSink Sink(PdfFilePath);
+		if (!Sink.Write(MoveTemp(PDFBytes), OutErrorMessage))
+		{
+			return false;
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("PDF generated successfully: %s"), *PdfFilePath);
+		return true;
 	}
-	
-	// Write PDF to file
-	if (!FFileHelper::SaveArrayToFile(PDFBytes, *PdfFilePath))
+
+	// Only the tail of the file is read: the newest xref section and the manifest before it
+	TUniquePtr<IFileHandle> ReadHandle(PlatformFile.OpenRead(*PdfFilePath));
+	if (!ReadHandle)
 	{
-		OutErrorMessage = FString::Printf(TEXT("Failed to write PDF file: %s"), *PdfFilePath);
+		OutErrorMessage = FString::Printf(TEXT("Failed to read PDF file: %s"), *PdfFilePath);
 		return false;
 	}
-	
-	UE_LOG(LogTemp, Log, TEXT("PDF generated successfully: %s"), *PdfFilePath);
+
+	auto ReadExisting = [&ReadHandle](int64 Offset, int64 Num, TArray<uint8>& OutBytes)
+	{
+		OutBytes.SetNumUninitialized((int32)Num);
+		return ReadHandle->Seek(Offset) && ReadHandle->Read(OutBytes.GetData(), Num);
+	};
+
+	const int64 ExistingSize = ReadHandle->Size();
+	const int64 CompleteLength = FPDFIncrementalUpdate::FindCompleteLength(ExistingSize, ReadExisting);
+	TArray<uint8> Update;
+	if (CompleteLength == INDEX_NONE)
+	{
+		OutErrorMessage = FString::Printf(TEXT("Cannot update %s: no complete revision (missing %%%%EOF)"), *PdfFilePath);
+		return false;
+	}
+	if (!FPDFIncrementalUpdate::Build(CompleteLength, ReadExisting, Document, Update, OutNumObjectsWritten, OutErrorMessage))
+	{
+		OutErrorMessage = FString::Printf(TEXT("Cannot update %s: %s"), *PdfFilePath, *OutErrorMessage);
+		return false;
+	}
+	ReadHandle.Reset();
+
+	if (Update.Num() == 0 && CompleteLength == ExistingSize)
+	{
+		UE_LOG(LogTemp, Log, TEXT("PDF already up to date: %s"), *PdfFilePath);
+		return true;
+	}
+
+	// Append only; earlier revisions are never rewritten. Bytes after the last %%EOF are what is left of
+	// an append that was cut short, and readers would take them for the newest revision, so they are
+	// cut off first. A failed write is truncated back the same way; a crash mid-write leaves a partial
+	// revision that the next append removes. The full flush makes the new trailer durable before we
+	// report success.
+	TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenWrite(*PdfFilePath, true));
+	if (!FileHandle)
+	{
+		OutErrorMessage = FString::Printf(TEXT("Failed to open PDF file for appending: %s"), *PdfFilePath);
+		return false;
+	}
+
+	if (CompleteLength < ExistingSize)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Removing %lld bytes of an incomplete revision from the end of %s"), ExistingSize - CompleteLength, *PdfFilePath);
+	}
+	if (!FileHandle->Truncate(CompleteLength) || !FileHandle->Seek(CompleteLength)
+		|| !FileHandle->Write(Update.GetData(), Update.Num()) || !FileHandle->Flush(true))
+	{
+		FileHandle->Truncate(CompleteLength);
+		OutErrorMessage = FString::Printf(TEXT("Failed to append to PDF file: %s"), *PdfFilePath);
+		return false;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Appended revision with %d changed objects (%d bytes) to %s"), OutNumObjectsWritten, Update.Num(), *PdfFilePath);
 	return true;
 }
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * PDF.BenchmarkParallelPages [NumVariants] [Iterations]
+ * Builds one large document with 1..N worker threads, with and without compression,
+ * and checks every result is byte-identical to the serial one.
+ */
+static FAutoConsoleCommand GBenchmarkParallelPagesCommand(
+	TEXT("PDF.BenchmarkParallelPages"),
+	TEXT("Time page serialization across thread counts. Usage: PDF.BenchmarkParallelPages [NumVariants] [Iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumVariants = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 20000;
+		const int32 Iterations = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 5;
+
+		// Unlimited list so the variants spill over hundreds of pages
+		FString ErrorMessage;
+		TSharedPtr<const FPDFLayoutProgram> Layout = FPDFLayoutProgram::Compile(TEXT(R"json(
+		{
+			"Fonts": { "F1": "Helvetica", "F2": "Helvetica-Bold" },
+			"Sections": [
+				{ "Font": "F2", "Size": 16, "Text": "Catalog: {ConfigurationName}" },
+				{ "Space": 20, "Font": "F1", "Size": 10, "List": "SelectedVariants", "Item": "{Index}. {Item}", "LineSpacing": 12 }
+			]
+		}
+		)json"), ErrorMessage);
+		check(Layout.IsValid());
+
+		FConfigurationData ConfigData;
+		ConfigData.ConfigurationName = TEXT("Benchmark");
+		ConfigData.SelectedVariants.Reserve(NumVariants);
+		for (int32 Index = 0; Index < NumVariants; ++Index)
+		{
+			ConfigData.SelectedVariants.Add(FString::Printf(TEXT("Variant Set %d: Option %d (Finish %d)"), Index % 17, Index, Index % 5));
+		}
+
+		const int32 MaxCores = FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+
+		for (const bool bCompress : { false, true })
+		{
+			FPDFWriteOptions SerialOptions;
+			SerialOptions.bCompressStreams = bCompress;
+			SerialOptions.MaxThreads = 1;
+			const TArray<uint8> Reference = FPDFGenerator::BuildPDFDocument(ConfigData, *Layout, SerialOptions);
+
+			TArray<FPDFLayoutPage> Pages;
+			Layout->Paginate(ConfigData, Pages);
+			UE_LOG(LogTemp, Display, TEXT("PDF.BenchmarkParallelPages: %d pages, %lld bytes, compression %s"),
+				Pages.Num(), (int64)Reference.Num(), bCompress ? TEXT("on") : TEXT("off"));
+
+			double SerialMs = 0.0;
+			for (int32 Threads = 1; Threads <= MaxCores; Threads = Threads < MaxCores ? FMath::Min(Threads * 2, MaxCores) : MaxCores + 1)
+			{
+				FPDFWriteOptions Options = SerialOptions;
+				Options.MaxThreads = Threads;
+
+				bool bIdentical = true;
+				const double StartTime = FPlatformTime::Seconds();
+				for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					bIdentical &= FPDFGenerator::BuildPDFDocument(ConfigData, *Layout, Options) == Reference;
+				}
+				const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / Iterations;
+				SerialMs = Threads == 1 ? ElapsedMs : SerialMs;
+
+				UE_LOG(LogTemp, Display, TEXT("  %2d threads: %8.2f ms  speedup %5.2fx  %s"),
+					Threads, ElapsedMs, SerialMs / FMath::Max(ElapsedMs, 1e-6), bIdentical ? TEXT("identical") : TEXT("MISMATCH"));
+			}
+		}
+	}));
+
+/**
+ * PDF.ValidateLinearization [Path]
+ * Without a path, builds linearized documents of 1, 2 and many pages and validates each;
+ * with a path, validates that file.
+ */
+static FAutoConsoleCommand GValidateLinearizationCommand(
+	TEXT("PDF.ValidateLinearization"),
+	TEXT("Check linearization parameters against the written bytes. Usage: PDF.ValidateLinearization [PdfPath]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FString ErrorMessage;
+
+		if (Args.Num() > 0)
+		{
+			TArray<uint8> Bytes;
+			if (!FFileHelper::LoadFileToArray(Bytes, *Args[0]))
+			{
+				UE_LOG(LogTemp, Error, TEXT("PDF.ValidateLinearization: Cannot read %s"), *Args[0]);
+			}
+			else if (FPDFLinearizer::Validate(Bytes, ErrorMessage))
+			{
+				UE_LOG(LogTemp, Display, TEXT("PDF.ValidateLinearization: %s is valid"), *Args[0]);
+			}
+			else
+			{
+				UE_LOG(LogTemp, Error, TEXT("PDF.ValidateLinearization: %s: %s"), *Args[0], *ErrorMessage);
+			}
+			return;
+		}
+
+		TSharedPtr<const FPDFLayoutProgram> Layout = FPDFLayoutProgram::Compile(TEXT(R"json(
+		{
+			"Fonts": { "F1": "Helvetica", "F2": "Helvetica-Bold" },
+			"Sections": [
+				{ "Font": "F2", "Size": 16, "Text": "Linearization test: {ConfigurationName}" },
+				{ "Space": 20, "Font": "F1", "Size": 10, "List": "SelectedVariants", "LineSpacing": 12 }
+			]
+		}
+		)json"), ErrorMessage);
+		check(Layout.IsValid());
+
+		int32 NumFailed = 0;
+		for (const int32 NumVariants : { 0, 60, 5000 })
+		{
+			for (const bool bCompress : { false, true })
+			{
+				FConfigurationData ConfigData;
+				ConfigData.ConfigurationName = FString::Printf(TEXT("%d variants"), NumVariants);
+				for (int32 Index = 0; Index < NumVariants; ++Index)
+				{
+					ConfigData.SelectedVariants.Add(FString::Printf(TEXT("Set %d: Option %d"), Index % 7, Index));
+				}
+
+				FPDFWriteOptions Options;
+				Options.bLinearize = true;
+				Options.bCompressStreams = bCompress;
+				const TArray<uint8> Bytes = FPDFGenerator::BuildPDFDocument(ConfigData, *Layout, Options);
+
+				const bool bValid = FPDFLinearizer::Validate(Bytes, ErrorMessage);
+				NumFailed += bValid ? 0 : 1;
+				UE_LOG(LogTemp, Display, TEXT("  %5d variants, compression %-3s: %s %s"),
+					NumVariants, bCompress ? TEXT("on") : TEXT("off"), bValid ? TEXT("OK") : TEXT("FAILED"), *ErrorMessage);
+			}
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("PDF.ValidateLinearization: %s"), NumFailed == 0 ? TEXT("all documents valid") : TEXT("FAILURES"));
+	}));
+
+/**
+ * PDF.TestIncrementalUpdate [NumVariants]
+ * Builds a document with a row of swatch images, then appends revisions that change one
+ * variant, insert a swatch in the middle and give one swatch an alpha channel. Each update
+ * must hold only the changed objects (no renumbered images), rebuilding the same revision
+ * must append nothing, and every object in the xref chain must be where the chain says.
+ * Finally a torn update ending in stray %%EOF bytes is appended and must be cut off by FindCompleteLength.
+ */
+static FAutoConsoleCommand GTestIncrementalUpdateCommand(
+	TEXT("PDF.TestIncrementalUpdate"),
+	TEXT("Append text, swatch and image changes as incremental updates and check them. Usage: PDF.TestIncrementalUpdate [NumVariants]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumVariants = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 2000;
+
+		FString ErrorMessage;
+		TSharedPtr<const FPDFLayoutProgram> Layout = FPDFLayoutProgram::Compile(TEXT(R"json(
+		{
+			"Fonts": { "F1": "Helvetica" },
+			"Sections": [
+				{ "Size": 16, "Text": "Incremental update test: {ConfigurationName}" },
+				{ "Space": 10, "Images": "SwatchImagePaths", "Width": 48, "Height": 48 },
+				{ "Space": 20, "Size": 10, "List": "SelectedVariants", "LineSpacing": 12 }
+			]
+		}
+		)json"), ErrorMessage);
+		check(Layout.IsValid());
+
+		FConfigurationData ConfigData;
+		ConfigData.ConfigurationName = TEXT("Revision 1");
+		for (int32 Index = 0; Index < NumVariants; ++Index)
+		{
+			ConfigData.SelectedVariants.Add(FString::Printf(TEXT("Set %d: Option %d"), Index % 7, Index));
+		}
+
+		// Swatches are incompressible noise standing in for image files, so a rewritten one shows in the update size
+		static constexpr int32 ImageBytes = 64 * 1024;
+		FRandomStream Random(NumVariants);
+		auto MakeImage = [&Random](bool bAlpha)
+		{
+			TSharedPtr<FPDFImage> Image = MakeShared<FPDFImage>();
+			Image->Width = 128;
+			Image->Height = 128;
+			Image->ColorSpace = TEXT("DeviceRGB");
+			Image->Filter = TEXT("FlateDecode");
+			Image->Data.SetNumUninitialized(ImageBytes);
+			for (uint8& Byte : Image->Data)
+			{
+				Byte = (uint8)Random.RandRange(0, 255);
+			}
+			if (bAlpha)
+			{
+				Image->AlphaData = TArray<uint8>(Image->Data.GetData(), ImageBytes / 4);
+			}
+			return TSharedPtr<const FPDFImage>(Image);
+		};
+
+		TArray<TPair<FString, TSharedPtr<const FPDFImage>>> Swatches;
+		for (int32 Index = 0; Index < 6; ++Index)
+		{
+			Swatches.Emplace(FString::Printf(TEXT("Swatches/Finish%d.png"), Index), MakeImage(false));
+		}
+
+		FPDFWriteOptions Options;
+		Options.bCompressStreams = true;
+		auto BuildRevision = [&](FPDFDocument& OutDocument)
+		{
+			FPDFDocumentImages Images;
+			ConfigData.SwatchImagePaths.Reset();
+			for (const TPair<FString, TSharedPtr<const FPDFImage>>& Swatch : Swatches)
+			{
+				ConfigData.SwatchImagePaths.Add(Swatch.Key);
+				FPDFLayoutImage& LayoutImage = Images.ByPath.Add(Swatch.Key);
+				LayoutImage.ResourceName = PDFGenerator::GetImageResourceName(Images.Images.Num());
+				LayoutImage.Width = Swatch.Value->Width;
+				LayoutImage.Height = Swatch.Value->Height;
+				Images.Images.Add(Swatch.Value);
+				Images.Paths.Add(Swatch.Key);
+			}
+
+			TArray<FPDFLayoutPage> Pages;
+			Layout->Paginate(ConfigData, Pages);
+			TArray<FPDFPageStream> PageStreams;
+			FPDFGenerator::SerializePages(ConfigData, *Layout, Pages, Images, Options, PageStreams);
+			FPDFGenerator::BuildDocumentModel(*Layout, Images, MoveTemp(PageStreams), OutDocument);
+		};
+
+		TArray<uint8> Bytes;
+		int32 NumFailed = 0;
+		auto AppendRevision = [&](const TCHAR* Change, int64 MaxUpdateBytes)
+		{
+			FPDFDocument Document;
+			BuildRevision(Document);
+
+			// Count what the update reads of the existing file
+			int64 BytesRead = 0;
+			TArray<uint8> Update;
+			int32 NumChanged = 0;
+			bool bValid = FPDFIncrementalUpdate::Build(Bytes.Num(), [&Bytes, &BytesRead](int64 Offset, int64 Num, TArray<uint8>& OutBytes)
+			{
+				BytesRead += Num;
+				OutBytes = TArray<uint8>(Bytes.GetData() + Offset, (int32)Num);
+				return true;
+			}, Document, Update, NumChanged, ErrorMessage) && Update.Num() <= MaxUpdateBytes;
+			Bytes.Append(Update);
+
+			// Rebuilding the same revision must produce an empty update
+			TArray<uint8> EmptyUpdate;
+			int32 NumUnchanged = 0;
+			bValid &= FPDFIncrementalUpdate::Build(Bytes, Document, EmptyUpdate, NumUnchanged, ErrorMessage) && EmptyUpdate.Num() == 0;
+
+			TMap<int64, int64> ObjectOffsets;
+			int64 LastXref = 0;
+			int64 Size = 0;
+			int32 NumSections = 0;
+			bValid &= FPDFIncrementalUpdate::ReadXrefChain(Bytes, ObjectOffsets, LastXref, Size, NumSections, ErrorMessage);
+			for (const TPair<int64, int64>& Entry : ObjectOffsets)
+			{
+				bValid &= PDFParsing::IsObjectAt(Bytes, Entry.Value, Entry.Key);
+			}
+
+			NumFailed += bValid ? 0 : 1;
+			UE_LOG(LogTemp, Display, TEXT("  %-24s %4d of %4d objects, %8d bytes appended, %8lld of %8lld bytes read: %s %s"),
+				Change, NumChanged, Document.NumObjects(), Update.Num(), BytesRead, (int64)Bytes.Num() - Update.Num(),
+				bValid ? TEXT("OK") : TEXT("FAILED"), *ErrorMessage);
+		};
+
+		AppendRevision(TEXT("First revision"), MAX_int64);
+
+		// No image may be rewritten for a text change
+		ConfigData.SelectedVariants[NumVariants / 2] = TEXT("Changed: Option X");
+		AppendRevision(TEXT("One variant changed"), ImageBytes / 2);
+
+		// Only the new swatch; the ones after it keep their object numbers
+		Swatches.Insert(TPair<FString, TSharedPtr<const FPDFImage>>(TEXT("Swatches/Inserted.png"), MakeImage(false)), Swatches.Num() / 2);
+		AppendRevision(TEXT("Swatch inserted"), ImageBytes * 3 / 2);
+
+		// The image and its new soft mask, nothing else of size
+		Swatches[1].Value = MakeImage(true);
+		AppendRevision(TEXT("Swatch gained alpha"), ImageBytes * 7 / 4);
+
+		// Half an update appended (a crash mid-write) must be found and cut off
+		const int64 CompleteSize = Bytes.Num();
+		ConfigData.ConfigurationName = TEXT("Torn revision");
+		FPDFDocument TornDocument;
+		BuildRevision(TornDocument);
+		TArray<uint8> TornUpdate;
+		int32 NumTorn = 0;
+		FPDFIncrementalUpdate::Build(Bytes, TornDocument, TornUpdate, NumTorn, ErrorMessage);
+		Bytes.Append(TornUpdate.GetData(), TornUpdate.Num() / 2);
+
+		// Stream data of the torn part may hold %%EOF bytes, even after a startxref that points nowhere
+		const ANSICHAR* StrayMarkers = "\x78\x9c%%EOF\r\nstartxref\n1\n%%EOF\n";
+		Bytes.Append((const uint8*)StrayMarkers, FCStringAnsi::Strlen(StrayMarkers));
+		const int64 FoundSize = FPDFIncrementalUpdate::FindCompleteLength(Bytes.Num(), [&Bytes](int64 Offset, int64 Num, TArray<uint8>& OutBytes)
+		{
+			OutBytes = TArray<uint8>(Bytes.GetData() + Offset, (int32)Num);
+			return true;
+		});
+		NumFailed += FoundSize == CompleteSize ? 0 : 1;
+		UE_LOG(LogTemp, Display, TEXT("  %-24s complete length %lld of %lld (expected %lld): %s"),
+			TEXT("Torn append"), FoundSize, (int64)Bytes.Num(), CompleteSize, FoundSize == CompleteSize ? TEXT("OK") : TEXT("FAILED"));
+
+		UE_LOG(LogTemp, Display, TEXT("PDF.TestIncrementalUpdate: %s"), NumFailed == 0 ? TEXT("all revisions valid") : TEXT("FAILURES"));
+	}));
+
+#endif
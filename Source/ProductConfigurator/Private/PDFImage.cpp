@@ -0,0 +1,296 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PDFImage.h"
+#include "PDFGenerator.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/SecureHash.h"
+#include "Modules/ModuleManager.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+
+namespace PDFImage
+{
+	struct FCache
+	{
+		FCriticalSection Lock;
+		TMap<FSHAHash, TSharedPtr<const FPDFImage>> Images;
+
+		/** Least recently used first */
+		TArray<FSHAHash> Order;
+
+		int64 TotalBytes = 0;
+	};
+
+	static FCache& GetCache()
+	{
+		static FCache Cache;
+		return Cache;
+	}
+
+	static int64 GetEncodedSize(const FPDFImage& Image)
+	{
+		return Image.Data.Num() + Image.AlphaData.Num();
+	}
+
+	static const TCHAR* GetColorSpace(int32 NumComponents)
+	{
+		switch (NumComponents)
+		{
+		case 1: return TEXT("DeviceGray");
+		case 4: return TEXT("DeviceCMYK");
+		default: return TEXT("DeviceRGB");
+		}
+	}
+}
+
+FString FPDFImage::GetStreamEntries() const
+{
+	FString Entries = FString::Printf(TEXT("/Type /XObject /Subtype /Image /Width %d /Height %d /ColorSpace /%s /BitsPerComponent 8"), Width, Height, *ColorSpace);
+	if (!Filter.IsEmpty())
+	{
+		Entries += FString::Printf(TEXT(" /Filter /%s"), *Filter);
+	}
+	if (bInvertedCMYK)
+	{
+		Entries += TEXT(" /Decode [1 0 1 0 1 0 1 0]");
+	}
+	return Entries;
+}
+
+FString FPDFImage::GetAlphaStreamEntries() const
+{
+	return FString::Printf(TEXT("/Type /XObject /Subtype /Image /Width %d /Height %d /ColorSpace /DeviceGray /BitsPerComponent 8 /Filter /FlateDecode"), Width, Height);
+}
+
+bool FPDFImageCache::ReadJPEGInfo(const uint8* Data, int64 Num, int32& OutWidth, int32& OutHeight, int32& OutComponents, bool& bOutAdobe, bool& bOutPassthrough)
+{
+	bOutAdobe = false;
+	bOutPassthrough = false;
+
+	if (Num < 4 || Data[0] != 0xFF || Data[1] != 0xD8)
+	{
+		return false;
+	}
+
+	// Walk the marker segments up to the frame header (SOFn)
+	int64 Pos = 2;
+	while (Pos + 4 <= Num)
+	{
+		if (Data[Pos] != 0xFF)
+		{
+			return false;
+		}
+
+		const uint8 Marker = Data[Pos + 1];
+		if (Marker == 0xFF)
+		{
+			// Fill byte
+			++Pos;
+			continue;
+		}
+		Pos += 2;
+
+		// Markers without a length field
+		if (Marker == 0x01 || (Marker >= 0xD0 && Marker <= 0xD7))
+		{
+			continue;
+		}
+
+		// End of image or start of scan before any frame header
+		if (Marker == 0xD9 || Marker == 0xDA)
+		{
+			return false;
+		}
+
+		const int32 Length = (Data[Pos] << 8) | Data[Pos + 1];
+		if (Length < 2 || Pos + Length > Num)
+		{
+			return false;
+		}
+
+		const uint8* Segment = Data + Pos + 2;
+		const int32 SegmentLength = Length - 2;
+
+		if (Marker == 0xEE && SegmentLength >= 5 && FMemory::Memcmp(Segment, "Adobe", 5) == 0)
+		{
+			bOutAdobe = true;
+		}
+
+		// C4 (DHT), C8 (reserved) and CC (DAC) share the range but are not frame headers
+		const bool bIsFrameHeader = Marker >= 0xC0 && Marker <= 0xCF && Marker != 0xC4 && Marker != 0xC8 && Marker != 0xCC;
+		if (bIsFrameHeader)
+		{
+			if (SegmentLength < 6)
+			{
+				return false;
+			}
+
+			const int32 Precision = Segment[0];
+			OutHeight = (Segment[1] << 8) | Segment[2];
+			OutWidth = (Segment[3] << 8) | Segment[4];
+			OutComponents = Segment[5];
+
+			// DCTDecode handles 8-bit Huffman-coded baseline, extended and progressive frames.
+			// A zero height means it is defined later by a DNL marker, which readers rarely support.
+			bOutPassthrough = Precision == 8
+				&& (Marker == 0xC0 || Marker == 0xC1 || Marker == 0xC2)
+				&& OutWidth > 0 && OutHeight > 0
+				&& (OutComponents == 1 || OutComponents == 3 || OutComponents == 4);
+			return true;
+		}
+
+		Pos += Length;
+	}
+
+	return false;
+}
+
+TSharedPtr<FPDFImage> FPDFImageCache::Encode(const TArray<uint8>& FileBytes, FString& OutErrorMessage)
+{
+	TSharedPtr<FPDFImage> Image = MakeShared<FPDFImage>();
+
+	// JPEG: embed the file as-is, the viewer decodes it
+	int32 NumComponents = 0;
+	bool bAdobe = false;
+	bool bPassthrough = false;
+	if (ReadJPEGInfo(FileBytes.GetData(), FileBytes.Num(), Image->Width, Image->Height, NumComponents, bAdobe, bPassthrough) && bPassthrough)
+	{
+		Image->ColorSpace = PDFImage::GetColorSpace(NumComponents);
+		Image->Filter = TEXT("DCTDecode");
+		Image->bInvertedCMYK = NumComponents == 4 && bAdobe;
+		Image->Data = FileBytes;
+		return Image;
+	}
+
+	// Anything else: decode to 8-bit pixels and Flate-compress them
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+	const EImageFormat Format = ImageWrapperModule.DetectImageFormat(FileBytes.GetData(), FileBytes.Num());
+	TSharedPtr<IImageWrapper> ImageWrapper = Format != EImageFormat::Invalid ? ImageWrapperModule.CreateImageWrapper(Format) : nullptr;
+	if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(FileBytes.GetData(), FileBytes.Num()))
+	{
+		OutErrorMessage = TEXT("Unsupported or corrupt image file");
+		return nullptr;
+	}
+
+	const int64 Width = ImageWrapper->GetWidth();
+	const int64 Height = ImageWrapper->GetHeight();
+	const bool bGray = ImageWrapper->GetFormat() == ERGBFormat::Gray;
+	const int64 NumChannels = bGray ? 1 : 4;
+	if (Width <= 0 || Height <= 0 || Width * Height * NumChannels > MAX_int32)
+	{
+		OutErrorMessage = FString::Printf(TEXT("Image size %lldx%lld is not supported"), Width, Height);
+		return nullptr;
+	}
+
+	TArray64<uint8> RawData;
+	if (!ImageWrapper->GetRaw(bGray ? ERGBFormat::Gray : ERGBFormat::RGBA, 8, RawData) || RawData.Num() != Width * Height * NumChannels)
+	{
+		OutErrorMessage = TEXT("Failed to decode image");
+		return nullptr;
+	}
+
+	Image->Width = (int32)Width;
+	Image->Height = (int32)Height;
+	Image->ColorSpace = PDFImage::GetColorSpace(bGray ? 1 : 3);
+
+	const int32 NumPixels = Image->Width * Image->Height;
+	if (bGray)
+	{
+		Image->Data.Append(RawData.GetData(), NumPixels);
+	}
+	else
+	{
+		// Split RGBA into the color stream and a soft mask, dropping the mask when fully opaque
+		Image->Data.SetNumUninitialized(NumPixels * 3);
+		Image->AlphaData.SetNumUninitialized(NumPixels);
+
+		bool bOpaque = true;
+		const uint8* Source = RawData.GetData();
+		uint8* Color = Image->Data.GetData();
+		for (int32 Pixel = 0; Pixel < NumPixels; ++Pixel, Source += 4, Color += 3)
+		{
+			Color[0] = Source[0];
+			Color[1] = Source[1];
+			Color[2] = Source[2];
+			Image->AlphaData[Pixel] = Source[3];
+			bOpaque &= Source[3] == 0xFF;
+		}
+
+		if (bOpaque || !FPDFGenerator::CompressStream(Image->AlphaData))
+		{
+			Image->AlphaData.Empty();
+		}
+	}
+
+	// Fall back to an unfiltered stream rather than failing the export
+	if (FPDFGenerator::CompressStream(Image->Data))
+	{
+		Image->Filter = TEXT("FlateDecode");
+	}
+
+	return Image;
+}
+
+TSharedPtr<const FPDFImage> FPDFImageCache::Load(const FString& FilePath, FString& OutErrorMessage)
+{
+	TArray<uint8> FileBytes;
+	if (!FFileHelper::LoadFileToArray(FileBytes, *FilePath))
+	{
+		OutErrorMessage = FString::Printf(TEXT("Failed to read image: %s"), *FilePath);
+		return nullptr;
+	}
+
+	FSHAHash Hash;
+	FSHA1::HashBuffer(FileBytes.GetData(), FileBytes.Num(), Hash.Hash);
+
+	PDFImage::FCache& Cache = PDFImage::GetCache();
+	{
+		FScopeLock Lock(&Cache.Lock);
+		if (const TSharedPtr<const FPDFImage>* Cached = Cache.Images.Find(Hash))
+		{
+			Cache.Order.Remove(Hash);
+			Cache.Order.Add(Hash);
+			return *Cached;
+		}
+	}
+
+	// Encode outside the lock so exports of different images do not wait on each other
+	TSharedPtr<const FPDFImage> Image = Encode(FileBytes, OutErrorMessage);
+	if (!Image.IsValid())
+	{
+		OutErrorMessage = FString::Printf(TEXT("%s: %s"), *OutErrorMessage, *FilePath);
+		return nullptr;
+	}
+
+	FScopeLock Lock(&Cache.Lock);
+	if (const TSharedPtr<const FPDFImage>* Cached = Cache.Images.Find(Hash))
+	{
+		// Another export encoded the same image in the meantime
+		return *Cached;
+	}
+
+	Cache.Images.Add(Hash, Image);
+	Cache.Order.Add(Hash);
+	Cache.TotalBytes += PDFImage::GetEncodedSize(*Image);
+
+	// Evict least recently used images, always keeping the one just added
+	while (Cache.TotalBytes > MaxCachedBytes && Cache.Order.Num() > 1)
+	{
+		const FSHAHash Oldest = Cache.Order[0];
+		Cache.Order.RemoveAt(0);
+		Cache.TotalBytes -= PDFImage::GetEncodedSize(*Cache.Images.FindChecked(Oldest));
+		Cache.Images.Remove(Oldest);
+	}
+
+	return Image;
+}
+
+void FPDFImageCache::Empty()
+{
+	PDFImage::FCache& Cache = PDFImage::GetCache();
+	FScopeLock Lock(&Cache.Lock);
+	Cache.Images.Empty();
+	Cache.Order.Empty();
+	Cache.TotalBytes = 0;
+}
@@ -0,0 +1,429 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PDFIncrementalUpdate.h"
+#include "PDFDocument.h"
+#include "PDFObjectWriter.h"
+#include "PDFParsing.h"
+#include "Hash/CityHash.h"
+
+namespace PDFIncrementalUpdate
+{
+	/** Trailer entry referring to the manifest of the revision */
+	static const ANSICHAR* ManifestKey = "/RevisionManifest";
+
+	/** The newest xref section is read in chunks starting at this size */
+	static constexpr int64 ReadChunkSize = 64 * 1024;
+
+	struct FManifestEntry
+	{
+		int32 Number = 0;
+
+		/** CityHash64 of the serialized object */
+		uint64 Hash = 0;
+	};
+
+	/** What an update needs to know about the newest revision, read from the tail of the file */
+	struct FPreviousRevision
+	{
+		int64 XrefOffset = 0;
+		int64 Size = 1;
+		int32 ManifestNumber = 0;
+		TMap<FString, FManifestEntry> Manifest;
+	};
+
+	/** Bytes before a %%EOF marker searched for its "startxref <offset>" line */
+	static constexpr int64 StartXrefWindow = 64;
+
+	/**
+	 * Check that the %%EOF marker at Marker ends a revision: it directly follows
+	 * "startxref <offset>" and the offset points at an xref keyword earlier in the file.
+	 * Compressed stream data of a torn append can contain the marker bytes, but not that.
+	 */
+	static bool IsRevisionEnd(int64 Marker, FPDFIncrementalUpdate::FReadRange ReadExisting)
+	{
+		using namespace PDFParsing;
+
+		const int64 WindowStart = FMath::Max<int64>(Marker - StartXrefWindow, 0);
+		TArray<uint8> Window;
+		if (!ReadExisting(WindowStart, Marker - WindowStart, Window))
+		{
+			return false;
+		}
+
+		const int64 StartXref = FindLastBytes(Window, "startxref");
+		int64 Pos = StartXref + 9;
+		int64 XrefOffset = 0;
+		if (StartXref == INDEX_NONE || !ReadInteger(Window, Pos, XrefOffset))
+		{
+			return false;
+		}
+		while (Pos < Window.Num() && IsWhitespace(Window[Pos]))
+		{
+			++Pos;
+		}
+		if (Pos != Window.Num() || XrefOffset >= WindowStart + StartXref)
+		{
+			return false;
+		}
+
+		TArray<uint8> Keyword;
+		return ReadExisting(XrefOffset, 4, Keyword) && StartsWith(Keyword, 0, "xref");
+	}
+
+	static void Append(TArray<uint8>& Out, const FString& Text)
+	{
+		FTCHARToUTF8 TextUTF8(*Text);
+		Out.Append((const uint8*)TextUTF8.Get(), TextUTF8.Length());
+	}
+
+	/** Parse the "Number Hash Key" lines of a manifest stream */
+	static void ParseManifest(const uint8* Data, int64 Num, int64 Size, TMap<FString, FManifestEntry>& OutManifest)
+	{
+		FUTF8ToTCHAR TextTCHAR((const ANSICHAR*)Data, (int32)Num);
+		const FString Text(TextTCHAR.Length(), TextTCHAR.Get());
+
+		TArray<FString> Lines;
+		Text.ParseIntoArrayLines(Lines);
+		for (const FString& Line : Lines)
+		{
+			FString NumberText;
+			FString Rest;
+			FString HashText;
+			FString Key;
+			if (!Line.Split(TEXT(" "), &NumberText, &Rest) || !Rest.Split(TEXT(" "), &HashText, &Key))
+			{
+				continue;
+			}
+
+			const int32 Number = FCString::Atoi(*NumberText);
+			if (Number > 0 && Number < Size && !Key.IsEmpty())
+			{
+				FManifestEntry& Entry = OutManifest.Add(Key);
+				Entry.Number = Number;
+				Entry.Hash = FCString::Strtoui64(*HashText, nullptr, 16);
+			}
+		}
+	}
+
+	/**
+	 * Read the newest xref section, its trailer and the manifest it lists.
+	 * A file without a manifest reads as one whose objects all have unknown keys.
+	 */
+	static bool ReadPreviousRevision(int64 ExistingSize, FPDFIncrementalUpdate::FReadRange ReadExisting, FPreviousRevision& OutPrevious, FString& OutErrorMessage)
+	{
+		using namespace PDFParsing;
+
+		TArray<uint8> Tail;
+		const int64 TailSize = FMath::Min<int64>(ExistingSize, 1024);
+		const int64 StartXref = ReadExisting(ExistingSize - TailSize, TailSize, Tail) ? FindLastBytes(Tail, "startxref") : INDEX_NONE;
+		int64 Pos = StartXref + 9;
+		if (StartXref == INDEX_NONE || !ReadInteger(Tail, Pos, OutPrevious.XrefOffset) || OutPrevious.XrefOffset >= ExistingSize)
+		{
+			OutErrorMessage = TEXT("No startxref at the end of the file");
+			return false;
+		}
+
+		// The newest section runs to the end of the file; read more until its trailer is complete
+		TArray<uint8> Section;
+		TMap<int64, int64> Entries;
+		int64 FirstEntry = 0;
+		int64 TrailerStart = 0;
+		int64 TrailerEnd = INDEX_NONE;
+		const int64 SectionSize = ExistingSize - OutPrevious.XrefOffset;
+		for (int64 ChunkSize = ReadChunkSize; TrailerEnd == INDEX_NONE; ChunkSize *= 4)
+		{
+			const int64 Num = FMath::Min(ChunkSize, SectionSize);
+			Entries.Reset();
+			if (!ReadExisting(OutPrevious.XrefOffset, Num, Section) || !StartsWith(Section, 0, "xref"))
+			{
+				OutErrorMessage = FString::Printf(TEXT("No cross-reference table at offset %lld (cross-reference streams are not supported)"), OutPrevious.XrefOffset);
+				return false;
+			}
+
+			if (ReadXrefSection(Section, 0, Entries, FirstEntry, TrailerStart))
+			{
+				TrailerEnd = FindBytes(Section, "startxref", TrailerStart, Section.Num());
+			}
+			if (TrailerEnd == INDEX_NONE && Num == SectionSize)
+			{
+				OutErrorMessage = FString::Printf(TEXT("Cross-reference table at offset %lld is truncated"), OutPrevious.XrefOffset);
+				return false;
+			}
+		}
+
+		if (!ReadKeyInteger(Section, TrailerStart, TrailerEnd, "/Size", OutPrevious.Size))
+		{
+			OutErrorMessage = TEXT("Trailer has no /Size");
+			return false;
+		}
+
+		// The manifest is the last object of its revision, so it ends where the xref section starts
+		int64 ManifestNumber = 0;
+		const int64* ManifestOffset = ReadKeyInteger(Section, TrailerStart, TrailerEnd, ManifestKey, ManifestNumber) ? Entries.Find(ManifestNumber) : nullptr;
+		TArray<uint8> ManifestBytes;
+		if (!ManifestOffset || *ManifestOffset >= OutPrevious.XrefOffset
+			|| !ReadExisting(*ManifestOffset, OutPrevious.XrefOffset - *ManifestOffset, ManifestBytes))
+		{
+			return true;
+		}
+
+		int64 Length = 0;
+		const int64 StreamStart = FindBytes(ManifestBytes, "stream\n", 0, ManifestBytes.Num());
+		if (StreamStart == INDEX_NONE || !ReadKeyInteger(ManifestBytes, 0, StreamStart, "/Length", Length)
+			|| StreamStart + 7 + Length > ManifestBytes.Num())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Ignoring unreadable revision manifest (object %lld)"), ManifestNumber);
+			return true;
+		}
+
+		OutPrevious.ManifestNumber = (int32)ManifestNumber;
+		ParseManifest(ManifestBytes.GetData() + StreamStart + 7, Length, OutPrevious.Size, OutPrevious.Manifest);
+		return true;
+	}
+}
+
+bool FPDFIncrementalUpdate::ReadXrefChain(const TArray<uint8>& Bytes, TMap<int64, int64>& OutObjectOffsets, int64& OutLastXrefOffset, int64& OutSize, int32& OutNumSections, FString& OutErrorMessage)
+{
+	using namespace PDFParsing;
+
+	OutObjectOffsets.Reset();
+	OutSize = 0;
+	OutNumSections = 0;
+
+	const int64 StartXref = FindLastBytes(Bytes, "startxref");
+	int64 Pos = StartXref + 9;
+	if (StartXref == INDEX_NONE || !ReadInteger(Bytes, Pos, OutLastXrefOffset))
+	{
+		OutErrorMessage = TEXT("No startxref at the end of the file");
+		return false;
+	}
+
+	// Objects shadowed by a newer section (in use or freed) are ignored in older ones
+	TSet<int64> FreedObjects;
+	TSet<int64> VisitedSections;
+	int64 XrefOffset = OutLastXrefOffset;
+	while (true)
+	{
+		if (VisitedSections.Contains(XrefOffset))
+		{
+			OutErrorMessage = FString::Printf(TEXT("Cross-reference chain loops back to offset %lld"), XrefOffset);
+			return false;
+		}
+		VisitedSections.Add(XrefOffset);
+
+		TMap<int64, int64> Entries;
+		TSet<int64> FreeEntries;
+		int64 FirstEntry = 0;
+		int64 TrailerStart = 0;
+		if (!ReadXrefSection(Bytes, XrefOffset, Entries, FirstEntry, TrailerStart, &FreeEntries))
+		{
+			OutErrorMessage = FString::Printf(TEXT("No cross-reference table at offset %lld (cross-reference streams are not supported)"), XrefOffset);
+			return false;
+		}
+		++OutNumSections;
+
+		for (const TPair<int64, int64>& Entry : Entries)
+		{
+			if (!OutObjectOffsets.Contains(Entry.Key) && !FreedObjects.Contains(Entry.Key))
+			{
+				OutObjectOffsets.Add(Entry.Key, Entry.Value);
+			}
+		}
+		for (const int64 ObjectNumber : FreeEntries)
+		{
+			if (!OutObjectOffsets.Contains(ObjectNumber))
+			{
+				FreedObjects.Add(ObjectNumber);
+			}
+		}
+
+		const int64 TrailerEnd = FindBytes(Bytes, "startxref", TrailerStart, Bytes.Num());
+		if (OutNumSections == 1 && !ReadKeyInteger(Bytes, TrailerStart, TrailerEnd, "/Size", OutSize))
+		{
+			OutErrorMessage = TEXT("Trailer has no /Size");
+			return false;
+		}
+
+		int64 PreviousOffset = 0;
+		if (!ReadKeyInteger(Bytes, TrailerStart, TrailerEnd, "/Prev", PreviousOffset))
+		{
+			return true;
+		}
+		XrefOffset = PreviousOffset;
+	}
+}
+
+bool FPDFIncrementalUpdate::Build(const TArray<uint8>& ExistingBytes, const FPDFDocument& Document, TArray<uint8>& OutUpdate, int32& OutNumChangedObjects, FString& OutErrorMessage)
+{
+	return Build(ExistingBytes.Num(), [&ExistingBytes](int64 Offset, int64 Num, TArray<uint8>& OutBytes)
+	{
+		if (Offset < 0 || Num < 0 || Offset + Num > ExistingBytes.Num())
+		{
+			return false;
+		}
+		OutBytes = TArray<uint8>(ExistingBytes.GetData() + Offset, (int32)Num);
+		return true;
+	}, Document, OutUpdate, OutNumChangedObjects, OutErrorMessage);
+}
+
+int64 FPDFIncrementalUpdate::FindCompleteLength(int64 ExistingSize, FReadRange ReadExisting)
+{
+	// Scan backwards; chunks overlap by the marker length less one so a marker split between two is still found
+	TArray<uint8> Chunk;
+	for (int64 End = ExistingSize; End > 0;)
+	{
+		const int64 Start = FMath::Max<int64>(End - PDFIncrementalUpdate::ReadChunkSize, 0);
+		if (!ReadExisting(Start, End - Start, Chunk))
+		{
+			return INDEX_NONE;
+		}
+
+		for (int64 Marker = Chunk.Num() - 5; Marker >= 0; --Marker)
+		{
+			if (!PDFParsing::StartsWith(Chunk, Marker, "%%EOF") || !PDFIncrementalUpdate::IsRevisionEnd(Start + Marker, ReadExisting))
+			{
+				continue;
+			}
+
+			// Keep the end of line that belongs to the marker
+			int64 Length = Start + Marker + 5;
+			TArray<uint8> EndOfLine;
+			if (ReadExisting(Length, FMath::Min<int64>(2, ExistingSize - Length), EndOfLine))
+			{
+				for (int32 Index = 0; Index < EndOfLine.Num() && (EndOfLine[Index] == '\r' || EndOfLine[Index] == '\n'); ++Index)
+				{
+					++Length;
+				}
+			}
+			return Length;
+		}
+
+		End = Start > 0 ? Start + 4 : 0;
+	}
+	return INDEX_NONE;
+}
+
+bool FPDFIncrementalUpdate::Build(int64 ExistingSize, FReadRange ReadExisting, const FPDFDocument& Document, TArray<uint8>& OutUpdate, int32& OutNumChangedObjects, FString& OutErrorMessage)
+{
+	using namespace PDFIncrementalUpdate;
+
+	OutUpdate.Reset();
+	OutNumChangedObjects = 0;
+	OutErrorMessage.Empty();
+
+	FPreviousRevision Previous;
+	if (ExistingSize > 0)
+	{
+		if (!ReadPreviousRevision(ExistingSize, ReadExisting, Previous, OutErrorMessage))
+		{
+			return false;
+		}
+
+		// The update must start on a new line
+		TArray<uint8> LastByte;
+		if (ReadExisting(ExistingSize - 1, 1, LastByte) && LastByte[0] != '\n' && LastByte[0] != '\r')
+		{
+			OutUpdate.Add('\n');
+		}
+	}
+	else
+	{
+		FPDFObjectWriter HeaderWriter(OutUpdate);
+		HeaderWriter.WriteHeader();
+	}
+
+	// Known keys keep their numbers; new keys and objects without one are numbered after everything the file uses
+	int32 NextNumber = (int32)FMath::Max<int64>(Previous.Size, 1);
+	TArray<int32> ObjectNumbers;
+	TArray<const FString*> Keys;
+	ObjectNumbers.SetNumZeroed(Document.NumObjects() + 1);
+	Keys.SetNumZeroed(Document.NumObjects() + 1);
+	TSet<FString> SeenKeys;
+	for (int32 Id = 1; Id <= Document.NumObjects(); ++Id)
+	{
+		const FString& Key = Document.GetObject(Id).Key;
+		bool bDuplicate = true;
+		if (!Key.IsEmpty())
+		{
+			SeenKeys.Add(Key, &bDuplicate);
+		}
+		Keys[Id] = bDuplicate ? nullptr : &Key;
+
+		const FManifestEntry* Entry = Keys[Id] ? Previous.Manifest.Find(Key) : nullptr;
+		ObjectNumbers[Id] = Entry ? Entry->Number : NextNumber++;
+	}
+	const int32 ManifestNumber = Previous.ManifestNumber > 0 ? Previous.ManifestNumber : NextNumber++;
+
+	// Serialize each object straight into the update and drop it again if the previous revision hashed the same.
+	// Keys this revision does not use stay in the manifest, so bringing an object back reuses its number.
+	TMap<FString, FManifestEntry> Manifest = MoveTemp(Previous.Manifest);
+	TArray<TPair<int32, int64>> WrittenObjects;
+	for (int32 Id = 1; Id <= Document.NumObjects(); ++Id)
+	{
+		const int64 Start = OutUpdate.Num();
+		Document.SerializeObject(Id, ObjectNumbers, OutUpdate);
+		const uint64 Hash = CityHash64((const char*)OutUpdate.GetData() + Start, (uint32)(OutUpdate.Num() - Start));
+
+		if (Keys[Id])
+		{
+			FManifestEntry& Entry = Manifest.FindOrAdd(*Keys[Id]);
+			if (Entry.Number == ObjectNumbers[Id] && Entry.Hash == Hash)
+			{
+				OutUpdate.SetNum(Start, EAllowShrinking::No);
+				continue;
+			}
+			Entry.Number = ObjectNumbers[Id];
+			Entry.Hash = Hash;
+		}
+
+		WrittenObjects.Add(TPair<int32, int64>(ObjectNumbers[Id], ExistingSize + Start));
+	}
+
+	if (WrittenObjects.Num() == 0)
+	{
+		OutUpdate.Reset();
+		return true;
+	}
+	OutNumChangedObjects = WrittenObjects.Num();
+
+	// The manifest goes last, right before the xref section, so the next update knows how much of it to read
+	FString ManifestText;
+	for (const TPair<FString, FManifestEntry>& Entry : Manifest)
+	{
+		ManifestText.Appendf(TEXT("%d %016llx %s\n"), Entry.Value.Number, Entry.Value.Hash, *Entry.Key);
+	}
+	FTCHARToUTF8 ManifestUTF8(*ManifestText);
+	WrittenObjects.Add(TPair<int32, int64>(ManifestNumber, ExistingSize + OutUpdate.Num()));
+	FPDFObjectWriter::AppendStreamObject(OutUpdate, ManifestNumber, FString(), (const uint8*)ManifestUTF8.Get(), ManifestUTF8.Length());
+
+	// One xref subsection per run of consecutive object numbers
+	WrittenObjects.Sort([](const TPair<int32, int64>& A, const TPair<int32, int64>& B) { return A.Key < B.Key; });
+	const int64 XrefOffset = ExistingSize + OutUpdate.Num();
+	Append(OutUpdate, TEXT("xref\n"));
+	if (ExistingSize == 0)
+	{
+		Append(OutUpdate, TEXT("0 1\n0000000000 65535 f \n"));
+	}
+	for (int32 RunStart = 0; RunStart < WrittenObjects.Num();)
+	{
+		int32 RunEnd = RunStart + 1;
+		while (RunEnd < WrittenObjects.Num() && WrittenObjects[RunEnd].Key == WrittenObjects[RunEnd - 1].Key + 1)
+		{
+			++RunEnd;
+		}
+
+		Append(OutUpdate, FString::Printf(TEXT("%d %d\n"), WrittenObjects[RunStart].Key, RunEnd - RunStart));
+		for (int32 Index = RunStart; Index < RunEnd; ++Index)
+		{
+			Append(OutUpdate, FString::Printf(TEXT("%010lld 00000 n \n"), WrittenObjects[Index].Value));
+		}
+		RunStart = RunEnd;
+	}
+
+	const int64 Size = FMath::Max<int64>(Previous.Size, NextNumber);
+	const FString PreviousEntry = ExistingSize > 0 ? FString::Printf(TEXT(" /Prev %lld"), Previous.XrefOffset) : FString();
+	Append(OutUpdate, FString::Printf(TEXT("trailer\n<< /Size %lld /Root %d 0 R%s %s %d 0 R >>\nstartxref\n%lld\n%%%%EOF\n"),
+		Size, ObjectNumbers[Document.Catalog], *PreviousEntry, ANSI_TO_TCHAR(ManifestKey), ManifestNumber, XrefOffset));
+
+	return true;
+}
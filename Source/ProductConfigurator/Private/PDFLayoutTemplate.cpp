@@ -0,0 +1,850 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PDFLayoutTemplate.h"
+#include "ConfigurationExportLibrary.h"
+#include "PDFFont.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/FileManager.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Dom/JsonObject.h"
+#include "UObject/UnrealType.h"
+
+namespace PDFLayout
+{
+	// Plain-text fallback for when Content/ProductConfig/Layouts/PDFLayout.json is missing or invalid.
+	// That file is the shipped layout; this only keeps exports readable until it is fixed.
+	static const TCHAR* DefaultTemplate = TEXT(R"json(
+{
+	"Version": 1,
+	"Page": { "Width": 612, "Height": 792, "Left": 50, "Top": 750, "Bottom": 50 },
+	"Fonts": { "F1": "Helvetica", "F2": "Helvetica-Bold" },
+	"Sections": [
+		{ "Font": "F2", "Size": 16, "Text": "Product Configuration Summary" },
+		{ "Space": 25, "Font": "F1", "Size": 11, "Text": "Configuration: {ConfigurationName}" },
+		{ "Space": 18, "Text": "Timestamp: {Timestamp}" },
+		{ "Space": 30, "List": "SelectedVariants", "Item": "{Item}", "LineSpacing": 14 },
+		{ "Space": 24, "Text": "Share Code: {ShareCode}", "SkipIfEmpty": "ShareCode" }
+	]
+}
+)json");
+
+	static constexpr int32 SupportedVersion = 1;
+
+	static void Append(TArray<uint8>& Out, const ANSICHAR* Text)
+	{
+		Out.Append((const uint8*)Text, FCStringAnsi::Strlen(Text));
+	}
+
+	/** Append a coordinate or size, without a fractional part when it is whole */
+	static void AppendNumber(TArray<uint8>& Out, float Value)
+	{
+		ANSICHAR Buffer[32];
+		const float Rounded = FMath::RoundToFloat(Value);
+		if (FMath::IsNearlyEqual(Value, Rounded, 0.005f))
+		{
+			FCStringAnsi::Sprintf(Buffer, "%d", (int32)Rounded);
+		}
+		else
+		{
+			FCStringAnsi::Sprintf(Buffer, "%.2f", Value);
+		}
+		Append(Out, Buffer);
+	}
+
+	/** Append UTF-8 text with the characters that are special inside PDF string literals escaped */
+	static void AppendEscaped(TArray<uint8>& Out, const FString& Value)
+	{
+		FTCHARToUTF8 ValueUTF8(*Value);
+		const uint8* Bytes = (const uint8*)ValueUTF8.Get();
+		const int32 Num = ValueUTF8.Length();
+
+		Out.Reserve(Out.Num() + Num + 8);
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			const uint8 Byte = Bytes[Index];
+			if (Byte == '\\' || Byte == '(' || Byte == ')')
+			{
+				Out.Add('\\');
+			}
+			Out.Add(Byte);
+		}
+	}
+
+	static const FString& GetField(const FStrProperty* Field, const FConfigurationData& Data)
+	{
+		return *Field->ContainerPtrToValuePtr<FString>(&Data);
+	}
+
+	static int32 GetListNum(const FArrayProperty* ListField, const FConfigurationData& Data)
+	{
+		FScriptArrayHelper ArrayHelper(ListField, ListField->ContainerPtrToValuePtr<void>(&Data));
+		return ArrayHelper.Num();
+	}
+
+	static const FString& GetListItem(const FArrayProperty* ListField, const FConfigurationData& Data, int32 Index)
+	{
+		FScriptArrayHelper ArrayHelper(ListField, ListField->ContainerPtrToValuePtr<void>(&Data));
+		return *(const FString*)ArrayHelper.GetRawPtr(Index);
+	}
+
+	static const FStrProperty* FindStringField(const FString& Name)
+	{
+		return FindFProperty<FStrProperty>(FConfigurationData::StaticStruct(), FName(*Name));
+	}
+
+	static const FArrayProperty* FindListField(const FString& Name)
+	{
+		const FArrayProperty* ArrayProperty = FindFProperty<FArrayProperty>(FConfigurationData::StaticStruct(), FName(*Name));
+		return ArrayProperty && ArrayProperty->Inner->IsA<FStrProperty>() ? ArrayProperty : nullptr;
+	}
+
+	static int32 GetShownItems(const FPDFLayoutInstruction& Instruction, int32 NumItems)
+	{
+		return Instruction.MaxItems > 0 ? FMath::Min(NumItems, Instruction.MaxItems) : NumItems;
+	}
+
+	static bool ReadImageSize(const FJsonObject& Section, int32 SectionIndex, FPDFLayoutInstruction& Instruction, FString& OutErrorMessage)
+	{
+		if (!Section.TryGetNumberField(TEXT("Width"), Instruction.ImageWidth) || !Section.TryGetNumberField(TEXT("Height"), Instruction.ImageHeight)
+			|| Instruction.ImageWidth <= 0.0f || Instruction.ImageHeight <= 0.0f)
+		{
+			OutErrorMessage = FString::Printf(TEXT("Section %d needs a positive image Width and Height"), SectionIndex);
+			return false;
+		}
+		return true;
+	}
+
+	/** Draw an image scaled to fit a box, keeping its aspect ratio, aligned to the top left corner */
+	static void AppendImage(TArray<uint8>& Out, const FPDFLayoutImage& Image, float X, float Y, float BoxWidth, float BoxHeight)
+	{
+		const float Scale = FMath::Min(BoxWidth / Image.Width, BoxHeight / Image.Height);
+		const float Width = Image.Width * Scale;
+		const float Height = Image.Height * Scale;
+
+		Append(Out, "q\n");
+		AppendNumber(Out, Width);
+		Append(Out, " 0 0 ");
+		AppendNumber(Out, Height);
+		Append(Out, " ");
+		AppendNumber(Out, X);
+		Append(Out, " ");
+		AppendNumber(Out, Y + BoxHeight - Height);
+		Append(Out, " cm\n/");
+		Append(Out, TCHAR_TO_ANSI(*Image.ResourceName));
+		Append(Out, " Do\nQ\n");
+	}
+
+	/** Draw the image (or row of images) of one placement; images missing from the document are left blank */
+	static void AppendImages(const FConfigurationData& Data, const FPDFLayoutInstruction& Instruction, const FPDFLayoutPlacement& Placement, const TMap<FString, FPDFLayoutImage>& Images, TArray<uint8>& Out)
+	{
+		if (Instruction.Op == EPDFLayoutOp::Image)
+		{
+			if (const FPDFLayoutImage* Image = Images.Find(GetField(Instruction.ImageField, Data)))
+			{
+				AppendImage(Out, *Image, Instruction.X, Placement.Y, Instruction.ImageWidth, Instruction.ImageHeight);
+			}
+			return;
+		}
+
+		const int32 LastItem = FMath::Min(Placement.Item + Instruction.ImagesPerRow, GetListNum(Instruction.ListField, Data));
+		for (int32 Item = Placement.Item; Item < LastItem; ++Item)
+		{
+			if (const FPDFLayoutImage* Image = Images.Find(GetListItem(Instruction.ListField, Data, Item)))
+			{
+				const float X = Instruction.X + (Item - Placement.Item) * (Instruction.ImageWidth + Instruction.ImageGap);
+				AppendImage(Out, *Image, X, Placement.Y, Instruction.ImageWidth, Instruction.ImageHeight);
+			}
+		}
+	}
+}
+
+void FPDFGlyphUsage::Append(const FPDFGlyphUsage& Other)
+{
+	Fonts.SetNum(FMath::Max(Fonts.Num(), Other.Fonts.Num()));
+	for (int32 FontIndex = 0; FontIndex < Other.Fonts.Num(); ++FontIndex)
+	{
+		Fonts[FontIndex].Append(Other.Fonts[FontIndex]);
+	}
+}
+
+bool FPDFLayoutProgram::CompileText(const FString& Text, const FPDFLayoutFont& Font, bool bAllowListTokens, int32& OutFirstSegment, int32& OutNumSegments, TArray<uint16>& OutLiteralGlyphs, FString& OutErrorMessage)
+{
+	OutFirstSegment = Segments.Num();
+
+	TSet<uint16> LiteralGlyphs;
+	FString Literal;
+	auto FlushLiteral = [this, &Literal, &Font, &LiteralGlyphs]()
+	{
+		if (!Literal.IsEmpty())
+		{
+			FPDFLayoutSegment& Segment = Segments.AddDefaulted_GetRef();
+			Segment.Token = EPDFLayoutToken::Literal;
+			Segment.LiteralStart = LiteralPool.Num();
+			if (Font.TrueType.IsValid())
+			{
+				// Kept with the instruction and added to a page's glyphs when the page draws it, so only text that is shown ends up in the subset
+				Font.TrueType->AppendGlyphs(Literal, LiteralPool, LiteralGlyphs);
+			}
+			else
+			{
+				PDFLayout::AppendEscaped(LiteralPool, Literal);
+			}
+			Segment.LiteralLength = LiteralPool.Num() - Segment.LiteralStart;
+			Literal.Reset();
+		}
+	};
+
+	for (int32 Index = 0; Index < Text.Len(); ++Index)
+	{
+		const TCHAR Char = Text[Index];
+
+		// {{ and }} are literal braces
+		if ((Char == TEXT('{') || Char == TEXT('}')) && Index + 1 < Text.Len() && Text[Index + 1] == Char)
+		{
+			Literal.AppendChar(Char);
+			++Index;
+			continue;
+		}
+
+		if (Char == TEXT('}'))
+		{
+			OutErrorMessage = FString::Printf(TEXT("Unmatched '}' in \"%s\""), *Text);
+			return false;
+		}
+
+		if (Char != TEXT('{'))
+		{
+			Literal.AppendChar(Char);
+			continue;
+		}
+
+		const int32 Close = Text.Find(TEXT("}"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Index + 1);
+		if (Close == INDEX_NONE)
+		{
+			OutErrorMessage = FString::Printf(TEXT("Unmatched '{' in \"%s\""), *Text);
+			return false;
+		}
+
+		const FString Name = Text.Mid(Index + 1, Close - Index - 1);
+		Index = Close;
+
+		FPDFLayoutSegment Segment;
+		if (bAllowListTokens && Name == TEXT("Index"))
+		{
+			Segment.Token = EPDFLayoutToken::ItemNumber;
+		}
+		else if (bAllowListTokens && Name == TEXT("Item"))
+		{
+			Segment.Token = EPDFLayoutToken::ItemValue;
+		}
+		else if (bAllowListTokens && Name == TEXT("Remaining"))
+		{
+			Segment.Token = EPDFLayoutToken::Remaining;
+		}
+		else if (const FStrProperty* Field = PDFLayout::FindStringField(Name))
+		{
+			Segment.Token = EPDFLayoutToken::Field;
+			Segment.Field = Field;
+		}
+		else
+		{
+			OutErrorMessage = FString::Printf(TEXT("Unknown field {%s} in \"%s\""), *Name, *Text);
+			return false;
+		}
+
+		FlushLiteral();
+		Segments.Add(Segment);
+	}
+
+	FlushLiteral();
+	OutNumSegments = Segments.Num() - OutFirstSegment;
+	OutLiteralGlyphs = LiteralGlyphs.Array();
+	return true;
+}
+
+TSharedPtr<const FPDFLayoutProgram> FPDFLayoutProgram::Compile(const FString& TemplateJson, FString& OutErrorMessage, TArray<FString>* OutFontFiles)
+{
+	OutErrorMessage.Empty();
+
+	TSharedPtr<FJsonObject> Root;
+	TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(TemplateJson);
+	if (!FJsonSerializer::Deserialize(JsonReader, Root) || !Root.IsValid())
+	{
+		OutErrorMessage = FString::Printf(TEXT("Failed to parse layout template: %s"), *JsonReader->GetErrorMessage());
+		return nullptr;
+	}
+
+	int32 Version = PDFLayout::SupportedVersion;
+	Root->TryGetNumberField(TEXT("Version"), Version);
+	if (Version != PDFLayout::SupportedVersion)
+	{
+		OutErrorMessage = FString::Printf(TEXT("Unsupported layout template version %d"), Version);
+		return nullptr;
+	}
+
+	TSharedRef<FPDFLayoutProgram> Program = MakeShared<FPDFLayoutProgram>();
+
+	// Page geometry (the right margin defaults to the left one)
+	float Left = 50.0f;
+	float Right = -1.0f;
+	const TSharedPtr<FJsonObject>* PageObject = nullptr;
+	if (Root->TryGetObjectField(TEXT("Page"), PageObject))
+	{
+		(*PageObject)->TryGetNumberField(TEXT("Width"), Program->PageWidth);
+		(*PageObject)->TryGetNumberField(TEXT("Height"), Program->PageHeight);
+		(*PageObject)->TryGetNumberField(TEXT("Left"), Left);
+		(*PageObject)->TryGetNumberField(TEXT("Right"), Right);
+		(*PageObject)->TryGetNumberField(TEXT("Top"), Program->Top);
+		(*PageObject)->TryGetNumberField(TEXT("Bottom"), Program->Bottom);
+	}
+
+	if (Program->PageWidth <= 0.0f || Program->PageHeight <= 0.0f || Program->Top <= Program->Bottom)
+	{
+		OutErrorMessage = TEXT("Layout template has an invalid page size or margins");
+		return nullptr;
+	}
+
+	if (Right < 0.0f)
+	{
+		Right = Left;
+	}
+
+	// Fonts, in declaration order
+	const TSharedPtr<FJsonObject>* FontsObject = nullptr;
+	if (Root->TryGetObjectField(TEXT("Fonts"), FontsObject))
+	{
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& FontPair : (*FontsObject)->Values)
+		{
+			FPDFLayoutFont& Font = Program->Fonts.AddDefaulted_GetRef();
+			Font.ResourceName = FontPair.Key;
+
+			// { "File": "ProductConfig/Fonts/MyFont.ttf" } embeds a TrueType font, parsed once through FPDFFontCache
+			const TSharedPtr<FJsonObject>* FontObject = nullptr;
+			if (FontPair.Value->TryGetObject(FontObject))
+			{
+				FString FontPath;
+				if (!(*FontObject)->TryGetStringField(TEXT("File"), FontPath) || FontPath.IsEmpty())
+				{
+					OutErrorMessage = FString::Printf(TEXT("Font %s has no File"), *FontPair.Key);
+					return nullptr;
+				}
+
+				const FString FullPath = FPaths::IsRelative(FontPath) ? FPaths::ProjectContentDir() / FontPath : FontPath;
+				if (OutFontFiles)
+				{
+					OutFontFiles->Add(FullPath);
+				}
+
+				FString FontError;
+				Font.TrueType = FPDFFontCache::Load(FullPath, FontError);
+				if (!Font.TrueType.IsValid())
+				{
+					OutErrorMessage = FString::Printf(TEXT("Font %s: %s"), *FontPair.Key, *FontError);
+					return nullptr;
+				}
+				continue;
+			}
+
+			if (!FontPair.Value->TryGetString(Font.BaseFont) || Font.BaseFont.IsEmpty())
+			{
+				OutErrorMessage = FString::Printf(TEXT("Font %s must name a standard PDF font or a font File"), *FontPair.Key);
+				return nullptr;
+			}
+		}
+	}
+
+	if (Program->Fonts.Num() == 0)
+	{
+		OutErrorMessage = TEXT("Layout template declares no fonts");
+		return nullptr;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* SectionsArray = nullptr;
+	if (!Root->TryGetArrayField(TEXT("Sections"), SectionsArray))
+	{
+		OutErrorMessage = TEXT("Layout template has no Sections array");
+		return nullptr;
+	}
+
+	// Font and size carry over from one section to the next
+	int32 FontIndex = 0;
+	float FontSize = 10.0f;
+
+	for (int32 SectionIndex = 0; SectionIndex < SectionsArray->Num(); ++SectionIndex)
+	{
+		const TSharedPtr<FJsonObject>* SectionObject = nullptr;
+		if (!(*SectionsArray)[SectionIndex]->TryGetObject(SectionObject))
+		{
+			OutErrorMessage = FString::Printf(TEXT("Section %d is not an object"), SectionIndex);
+			return nullptr;
+		}
+		const FJsonObject& Section = **SectionObject;
+
+		FString FontName;
+		if (Section.TryGetStringField(TEXT("Font"), FontName))
+		{
+			FontIndex = Program->Fonts.IndexOfByPredicate([&FontName](const FPDFLayoutFont& Font) { return Font.ResourceName == FontName; });
+			if (FontIndex == INDEX_NONE)
+			{
+				OutErrorMessage = FString::Printf(TEXT("Section %d uses undeclared font %s"), SectionIndex, *FontName);
+				return nullptr;
+			}
+		}
+		Section.TryGetNumberField(TEXT("Size"), FontSize);
+
+		FPDFLayoutInstruction Instruction;
+		Instruction.FontIndex = FontIndex;
+		Instruction.FontSize = FontSize;
+		Instruction.X = Left;
+		Section.TryGetNumberField(TEXT("X"), Instruction.X);
+		Section.TryGetNumberField(TEXT("Space"), Instruction.SpaceBefore);
+
+		FString SkipIfEmpty;
+		if (Section.TryGetStringField(TEXT("SkipIfEmpty"), SkipIfEmpty))
+		{
+			Instruction.SkipIfEmpty = PDFLayout::FindStringField(SkipIfEmpty);
+			if (!Instruction.SkipIfEmpty)
+			{
+				OutErrorMessage = FString::Printf(TEXT("Section %d: unknown SkipIfEmpty field %s"), SectionIndex, *SkipIfEmpty);
+				return nullptr;
+			}
+		}
+
+		FString Text;
+		FString ListName;
+		FString ImageName;
+		if (Section.TryGetStringField(TEXT("List"), ListName))
+		{
+			Instruction.Op = EPDFLayoutOp::List;
+			Instruction.ListField = PDFLayout::FindListField(ListName);
+			if (!Instruction.ListField)
+			{
+				OutErrorMessage = FString::Printf(TEXT("Section %d: %s is not a string array field"), SectionIndex, *ListName);
+				return nullptr;
+			}
+
+			FString ItemText = TEXT("{Item}");
+			Section.TryGetStringField(TEXT("Item"), ItemText);
+			if (!Program->CompileText(ItemText, Program->Fonts[FontIndex], true, Instruction.FirstSegment, Instruction.NumSegments, Instruction.LiteralGlyphs, OutErrorMessage))
+			{
+				return nullptr;
+			}
+
+			FString MoreText;
+			if (Section.TryGetStringField(TEXT("More"), MoreText)
+				&& !Program->CompileText(MoreText, Program->Fonts[FontIndex], true, Instruction.FirstMoreSegment, Instruction.NumMoreSegments, Instruction.MoreLiteralGlyphs, OutErrorMessage))
+			{
+				return nullptr;
+			}
+
+			Instruction.LineSpacing = FontSize * 1.4f;
+			Section.TryGetNumberField(TEXT("LineSpacing"), Instruction.LineSpacing);
+			Section.TryGetNumberField(TEXT("MaxItems"), Instruction.MaxItems);
+		}
+		else if (Section.TryGetStringField(TEXT("Image"), ImageName))
+		{
+			Instruction.Op = EPDFLayoutOp::Image;
+			Instruction.ImageField = PDFLayout::FindStringField(ImageName);
+			if (!Instruction.ImageField)
+			{
+				OutErrorMessage = FString::Printf(TEXT("Section %d: %s is not a string field"), SectionIndex, *ImageName);
+				return nullptr;
+			}
+
+			if (!PDFLayout::ReadImageSize(Section, SectionIndex, Instruction, OutErrorMessage))
+			{
+				return nullptr;
+			}
+		}
+		else if (Section.TryGetStringField(TEXT("Images"), ListName))
+		{
+			Instruction.Op = EPDFLayoutOp::ImageRow;
+			Instruction.ListField = PDFLayout::FindListField(ListName);
+			if (!Instruction.ListField)
+			{
+				OutErrorMessage = FString::Printf(TEXT("Section %d: %s is not a string array field"), SectionIndex, *ListName);
+				return nullptr;
+			}
+
+			if (!PDFLayout::ReadImageSize(Section, SectionIndex, Instruction, OutErrorMessage))
+			{
+				return nullptr;
+			}
+
+			// As many images per row as fit between X and the right margin, at least one
+			Instruction.ImageGap = 6.0f;
+			Section.TryGetNumberField(TEXT("Gap"), Instruction.ImageGap);
+			const float RowWidth = Program->PageWidth - Right - Instruction.X;
+			Instruction.ImagesPerRow = FMath::Max(1, FMath::FloorToInt((RowWidth + Instruction.ImageGap) / (Instruction.ImageWidth + Instruction.ImageGap)));
+		}
+		else if (Section.TryGetStringField(TEXT("Text"), Text))
+		{
+			Instruction.Op = EPDFLayoutOp::Text;
+			if (!Program->CompileText(Text, Program->Fonts[FontIndex], false, Instruction.FirstSegment, Instruction.NumSegments, Instruction.LiteralGlyphs, OutErrorMessage))
+			{
+				return nullptr;
+			}
+		}
+		else
+		{
+			OutErrorMessage = FString::Printf(TEXT("Section %d needs a Text, List, Image or Images entry"), SectionIndex);
+			return nullptr;
+		}
+
+		Program->Instructions.Add(Instruction);
+	}
+
+	return Program;
+}
+
+void FPDFLayoutProgram::Paginate(const FConfigurationData& Data, TArray<FPDFLayoutPage>& OutPages) const
+{
+	OutPages.Reset();
+	FPDFLayoutPage* Page = &OutPages.AddDefaulted_GetRef();
+	float Y = Top;
+
+	// Extent is how far the placed element reaches above Y (the height of an image, zero for text)
+	auto Place = [this, &OutPages, &Page, &Y](int32 InstructionIndex, int32 Item, float Advance, float Extent = 0.0f)
+	{
+		float NewY = Y - Advance;
+		if (NewY < Bottom && Page->Placements.Num() > 0)
+		{
+			Page = &OutPages.AddDefaulted_GetRef();
+			NewY = Top - Extent;
+		}
+		Y = NewY;
+
+		FPDFLayoutPlacement& Placement = Page->Placements.AddDefaulted_GetRef();
+		Placement.Instruction = InstructionIndex;
+		Placement.Item = Item;
+		Placement.Y = Y;
+	};
+
+	for (int32 InstructionIndex = 0; InstructionIndex < Instructions.Num(); ++InstructionIndex)
+	{
+		const FPDFLayoutInstruction& Instruction = Instructions[InstructionIndex];
+
+		if (Instruction.SkipIfEmpty && PDFLayout::GetField(Instruction.SkipIfEmpty, Data).IsEmpty())
+		{
+			continue;
+		}
+
+		if (Instruction.Op == EPDFLayoutOp::Text)
+		{
+			Place(InstructionIndex, INDEX_NONE, Instruction.SpaceBefore);
+			continue;
+		}
+
+		if (Instruction.Op == EPDFLayoutOp::Image)
+		{
+			if (!PDFLayout::GetField(Instruction.ImageField, Data).IsEmpty())
+			{
+				Place(InstructionIndex, INDEX_NONE, Instruction.SpaceBefore + Instruction.ImageHeight, Instruction.ImageHeight);
+			}
+			continue;
+		}
+
+		const int32 NumItems = PDFLayout::GetListNum(Instruction.ListField, Data);
+
+		if (Instruction.Op == EPDFLayoutOp::ImageRow)
+		{
+			for (int32 Item = 0; Item < NumItems; Item += Instruction.ImagesPerRow)
+			{
+				const float Space = Item == 0 ? Instruction.SpaceBefore : Instruction.ImageGap;
+				Place(InstructionIndex, Item, Space + Instruction.ImageHeight, Instruction.ImageHeight);
+			}
+			continue;
+		}
+
+		const int32 NumShown = PDFLayout::GetShownItems(Instruction, NumItems);
+		for (int32 Item = 0; Item < NumShown; ++Item)
+		{
+			Place(InstructionIndex, Item, Item == 0 ? Instruction.SpaceBefore : Instruction.LineSpacing);
+		}
+
+		if (NumShown < NumItems && Instruction.NumMoreSegments > 0)
+		{
+			Place(InstructionIndex, FPDFLayoutPlacement::MoreLine, NumShown == 0 ? Instruction.SpaceBefore : Instruction.LineSpacing);
+		}
+	}
+}
+
+void FPDFLayoutProgram::AppendSegments(const FConfigurationData& Data, const FPDFLayoutInstruction& Instruction, int32 FirstSegment, int32 NumSegments, int32 Item, TArray<uint8>& OutStream, FPDFGlyphUsage& OutGlyphs) const
+{
+	const FPDFTrueTypeFont* TrueType = Fonts[Instruction.FontIndex].TrueType.Get();
+	TSet<uint16>* UsedGlyphs = TrueType ? &OutGlyphs.Fonts[Instruction.FontIndex] : nullptr;
+
+	auto AppendText = [TrueType, UsedGlyphs, &OutStream](const FString& Text)
+	{
+		if (TrueType)
+		{
+			TrueType->AppendGlyphs(Text, OutStream, *UsedGlyphs);
+		}
+		else
+		{
+			PDFLayout::AppendEscaped(OutStream, Text);
+		}
+	};
+
+	auto AppendCount = [TrueType, &AppendText, &OutStream](int32 Count)
+	{
+		if (TrueType)
+		{
+			AppendText(FString::FromInt(Count));
+		}
+		else
+		{
+			PDFLayout::AppendNumber(OutStream, (float)Count);
+		}
+	};
+
+	for (int32 SegmentIndex = FirstSegment; SegmentIndex < FirstSegment + NumSegments; ++SegmentIndex)
+	{
+		const FPDFLayoutSegment& Segment = Segments[SegmentIndex];
+		switch (Segment.Token)
+		{
+		case EPDFLayoutToken::Literal:
+			// Its glyphs were recorded by SerializePage, once for the whole template
+			OutStream.Append(LiteralPool.GetData() + Segment.LiteralStart, Segment.LiteralLength);
+			break;
+
+		case EPDFLayoutToken::Field:
+			AppendText(PDFLayout::GetField(Segment.Field, Data));
+			break;
+
+		case EPDFLayoutToken::ItemNumber:
+			AppendCount(Item + 1);
+			break;
+
+		case EPDFLayoutToken::ItemValue:
+			if (Item >= 0)
+			{
+				AppendText(PDFLayout::GetListItem(Instruction.ListField, Data, Item));
+			}
+			break;
+
+		case EPDFLayoutToken::Remaining:
+		{
+			const int32 NumItems = PDFLayout::GetListNum(Instruction.ListField, Data);
+			AppendCount(NumItems - PDFLayout::GetShownItems(Instruction, NumItems));
+			break;
+		}
+		}
+	}
+}
+
+void FPDFLayoutProgram::CollectImagePaths(const FConfigurationData& Data, TArray<FString>& OutPaths) const
+{
+	OutPaths.Reset();
+
+	for (const FPDFLayoutInstruction& Instruction : Instructions)
+	{
+		if (Instruction.SkipIfEmpty && PDFLayout::GetField(Instruction.SkipIfEmpty, Data).IsEmpty())
+		{
+			continue;
+		}
+
+		if (Instruction.Op == EPDFLayoutOp::Image)
+		{
+			const FString& Path = PDFLayout::GetField(Instruction.ImageField, Data);
+			if (!Path.IsEmpty())
+			{
+				OutPaths.AddUnique(Path);
+			}
+		}
+		else if (Instruction.Op == EPDFLayoutOp::ImageRow)
+		{
+			const int32 NumItems = PDFLayout::GetListNum(Instruction.ListField, Data);
+			for (int32 Item = 0; Item < NumItems; ++Item)
+			{
+				const FString& Path = PDFLayout::GetListItem(Instruction.ListField, Data, Item);
+				if (!Path.IsEmpty())
+				{
+					OutPaths.AddUnique(Path);
+				}
+			}
+		}
+	}
+}
+
+void FPDFLayoutProgram::SerializePage(const FConfigurationData& Data, const FPDFLayoutPage& Page, const TMap<FString, FPDFLayoutImage>& Images, TArray<uint8>& OutStream, FPDFGlyphUsage& OutGlyphs) const
+{
+	OutGlyphs.Fonts.SetNum(Fonts.Num());
+
+	PDFLayout::Append(OutStream, "BT\n");
+	bool bInTextObject = true;
+
+	int32 CurrentFont = INDEX_NONE;
+	float CurrentSize = 0.0f;
+	float PreviousX = 0.0f;
+	float PreviousY = 0.0f;
+
+	// Literal glyphs of each template (two per instruction: items and "more" line) are recorded on first use
+	TArray<bool> LiteralGlyphsRecorded;
+	LiteralGlyphsRecorded.SetNumZeroed(Instructions.Num() * 2);
+
+	for (const FPDFLayoutPlacement& Placement : Page.Placements)
+	{
+		const FPDFLayoutInstruction& Instruction = Instructions[Placement.Instruction];
+
+		// Images cannot be drawn inside a text object
+		if (Instruction.Op == EPDFLayoutOp::Image || Instruction.Op == EPDFLayoutOp::ImageRow)
+		{
+			if (bInTextObject)
+			{
+				PDFLayout::Append(OutStream, "ET\n");
+				bInTextObject = false;
+			}
+			PDFLayout::AppendImages(Data, Instruction, Placement, Images, OutStream);
+			continue;
+		}
+
+		// A new text object starts at the origin again; the font is graphics state and carries over
+		if (!bInTextObject)
+		{
+			PDFLayout::Append(OutStream, "BT\n");
+			bInTextObject = true;
+			PreviousX = 0.0f;
+			PreviousY = 0.0f;
+		}
+
+		if (Instruction.FontIndex != CurrentFont || Instruction.FontSize != CurrentSize)
+		{
+			CurrentFont = Instruction.FontIndex;
+			CurrentSize = Instruction.FontSize;
+
+			PDFLayout::Append(OutStream, "/");
+			PDFLayout::Append(OutStream, TCHAR_TO_ANSI(*Fonts[CurrentFont].ResourceName));
+			PDFLayout::Append(OutStream, " ");
+			PDFLayout::AppendNumber(OutStream, CurrentSize);
+			PDFLayout::Append(OutStream, " Tf\n");
+		}
+
+		// Td is relative to the start of the previous line (absolute for the first one)
+		PDFLayout::AppendNumber(OutStream, Instruction.X - PreviousX);
+		PDFLayout::Append(OutStream, " ");
+		PDFLayout::AppendNumber(OutStream, Placement.Y - PreviousY);
+		// Embedded fonts draw 2-byte glyph ids, written as a hex string
+		const bool bHexString = Fonts[CurrentFont].TrueType.IsValid();
+		PDFLayout::Append(OutStream, bHexString ? " Td\n<" : " Td\n(");
+		PreviousX = Instruction.X;
+		PreviousY = Placement.Y;
+
+		const bool bMoreLine = Placement.Item == FPDFLayoutPlacement::MoreLine;
+		bool& bLiteralGlyphsRecorded = LiteralGlyphsRecorded[Placement.Instruction * 2 + (bMoreLine ? 1 : 0)];
+		if (bHexString && !bLiteralGlyphsRecorded)
+		{
+			OutGlyphs.Fonts[CurrentFont].Append(bMoreLine ? Instruction.MoreLiteralGlyphs : Instruction.LiteralGlyphs);
+			bLiteralGlyphsRecorded = true;
+		}
+
+		if (bMoreLine)
+		{
+			AppendSegments(Data, Instruction, Instruction.FirstMoreSegment, Instruction.NumMoreSegments, Placement.Item, OutStream, OutGlyphs);
+		}
+		else
+		{
+			AppendSegments(Data, Instruction, Instruction.FirstSegment, Instruction.NumSegments, Placement.Item, OutStream, OutGlyphs);
+		}
+
+		PDFLayout::Append(OutStream, bHexString ? "> Tj\n" : ") Tj\n");
+	}
+
+	if (bInTextObject)
+	{
+		PDFLayout::Append(OutStream, "ET");
+	}
+}
+
+TSharedRef<const FPDFLayoutProgram> FPDFLayoutTemplateCache::GetDefault()
+{
+	static const TSharedRef<const FPDFLayoutProgram> DefaultProgram = []()
+	{
+		FString ErrorMessage;
+		TSharedPtr<const FPDFLayoutProgram> Program = FPDFLayoutProgram::Compile(PDFLayout::DefaultTemplate, ErrorMessage);
+		checkf(Program.IsValid(), TEXT("Built-in PDF layout failed to compile: %s"), *ErrorMessage);
+		return Program.ToSharedRef();
+	}();
+
+	return DefaultProgram;
+}
+
+FString FPDFLayoutTemplateCache::GetTemplatePath()
+{
+	return FPaths::ProjectContentDir() / TEXT("ProductConfig/Layouts/PDFLayout.json");
+}
+
+TSharedRef<const FPDFLayoutProgram> FPDFLayoutTemplateCache::Get()
+{
+	static FCriticalSection CacheLock;
+	static TSharedPtr<const FPDFLayoutProgram> CachedProgram;
+	static FDateTime CachedTimestamp;
+
+	// The compiled program holds the parsed fonts, so a replaced font file needs a recompile too
+	static TArray<TPair<FString, FDateTime>> CachedFontFiles;
+
+	const FString TemplatePath = GetTemplatePath();
+
+	// One stat per export and font file; the template is only re-read when one of them changes on disk
+	const FDateTime Timestamp = IFileManager::Get().GetTimeStamp(*TemplatePath);
+
+	FScopeLock Lock(&CacheLock);
+	if (CachedProgram.IsValid() && Timestamp == CachedTimestamp)
+	{
+		bool bFontFileChanged = false;
+		for (const TPair<FString, FDateTime>& FontFile : CachedFontFiles)
+		{
+			if (IFileManager::Get().GetTimeStamp(*FontFile.Key) != FontFile.Value)
+			{
+				bFontFileChanged = true;
+				break;
+			}
+		}
+
+		if (!bFontFileChanged)
+		{
+			return CachedProgram.ToSharedRef();
+		}
+	}
+
+	CachedTimestamp = Timestamp;
+	CachedProgram = GetDefault();
+	CachedFontFiles.Reset();
+
+	if (Timestamp == FDateTime::MinValue())
+	{
+		UE_LOG(LogTemp, Log, TEXT("No PDF layout template at %s, using built-in layout"), *TemplatePath);
+		return CachedProgram.ToSharedRef();
+	}
+
+	FString TemplateJson;
+	FString ErrorMessage;
+	if (!FFileHelper::LoadFileToString(TemplateJson, *TemplatePath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to read PDF layout template %s, using built-in layout"), *TemplatePath);
+	}
+	else
+	{
+		// Font files are watched even when compiling fails, so fixing a missing or broken font is picked up
+		TArray<FString> FontFiles;
+		if (TSharedPtr<const FPDFLayoutProgram> Program = FPDFLayoutProgram::Compile(TemplateJson, ErrorMessage, &FontFiles))
+		{
+			CachedProgram = Program;
+			UE_LOG(LogTemp, Log, TEXT("Compiled PDF layout template: %s"), *TemplatePath);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Invalid PDF layout template %s (%s), using built-in layout"), *TemplatePath, *ErrorMessage);
+		}
+
+		for (const FString& FontFile : FontFiles)
+		{
+			CachedFontFiles.Emplace(FontFile, IFileManager::Get().GetTimeStamp(*FontFile));
+		}
+	}
+
+	return CachedProgram.ToSharedRef();
+}
@@ -0,0 +1,588 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PDFLinearizer.h"
+#include "PDFDocument.h"
+#include "PDFParsing.h"
+
+namespace PDFLinearizer
+{
+	static const ANSICHAR* Header = "%PDF-1.4\n%\xE2\xE3\xCF\xD3\n";
+
+	/** Packs hint table fields most significant bit first */
+	class FHintBitWriter
+	{
+	public:
+		explicit FHintBitWriter(TArray<uint8>& InOutput)
+			: Output(InOutput)
+		{
+		}
+
+		void Write(uint64 Value, int32 NumBits)
+		{
+			for (int32 Bit = NumBits - 1; Bit >= 0; --Bit)
+			{
+				Current = (uint8)((Current << 1) | ((Value >> Bit) & 1));
+				if (++BitsInCurrent == 8)
+				{
+					Output.Add(Current);
+					Current = 0;
+					BitsInCurrent = 0;
+				}
+			}
+		}
+
+		/** Pad to a byte boundary (every item group of a hint table starts on one) */
+		void Flush()
+		{
+			if (BitsInCurrent > 0)
+			{
+				Output.Add((uint8)(Current << (8 - BitsInCurrent)));
+				Current = 0;
+				BitsInCurrent = 0;
+			}
+		}
+
+	private:
+		TArray<uint8>& Output;
+		uint8 Current = 0;
+		int32 BitsInCurrent = 0;
+	};
+
+	/** Bits needed to store values in [0, Value] */
+	static int32 BitsFor(int64 Value)
+	{
+		return Value > 0 ? (int32)FMath::FloorLog2_64((uint64)Value) + 1 : 0;
+	}
+
+	static void Append(TArray<uint8>& Out, const FString& Text)
+	{
+		FTCHARToUTF8 TextUTF8(*Text);
+		Out.Append((const uint8*)TextUTF8.Get(), TextUTF8.Length());
+	}
+
+	/** Linearization dictionary with fixed-width numbers so it can be sized before the offsets are known */
+	static FString FormatParameterDictionary(int32 ObjectNumber, int64 FileLength, int64 HintOffset, int64 HintLength, int32 FirstPageObject, int64 EndOfFirstPage, int32 NumPages, int64 MainXrefEntry)
+	{
+		return FString::Printf(
+			TEXT("%d 0 obj\n<< /Linearized 1 /L %10lld /H [ %10lld %10lld ] /O %10d /E %10lld /N %10d /T %10lld >>\nendobj\n"),
+			ObjectNumber, FileLength, HintOffset, HintLength, FirstPageObject, EndOfFirstPage, NumPages, MainXrefEntry);
+	}
+
+	static FString FormatXrefEntry(int64 Offset)
+	{
+		return FString::Printf(TEXT("%010lld 00000 n \n"), Offset);
+	}
+}
+
+void FPDFLinearizer::Write(const FPDFDocument& Document, TArray<uint8>& OutBytes)
+{
+	using namespace PDFLinearizer;
+
+	const int32 NumPages = Document.Pages.Num();
+	check(NumPages > 0 && Document.PageContents.Num() == NumPages && Document.Catalog != INDEX_NONE);
+
+	// Group objects: first page (page, content, then every shared object), other pages, the rest
+	TArray<int32> FirstPageIds = { Document.Pages[0], Document.PageContents[0] };
+	FirstPageIds.Append(Document.SharedObjects);
+
+	TArray<bool> bAssigned;
+	bAssigned.Init(false, Document.NumObjects() + 1);
+	bAssigned[Document.Catalog] = true;
+	for (int32 PageIndex = 0; PageIndex < NumPages; ++PageIndex)
+	{
+		bAssigned[Document.Pages[PageIndex]] = true;
+		bAssigned[Document.PageContents[PageIndex]] = true;
+	}
+	for (const int32 Id : Document.SharedObjects)
+	{
+		bAssigned[Id] = true;
+	}
+
+	TArray<int32> OtherIds;
+	for (int32 Id = 1; Id <= Document.NumObjects(); ++Id)
+	{
+		if (!bAssigned[Id])
+		{
+			OtherIds.Add(Id);
+		}
+	}
+
+	// Main section (remaining pages, other objects) gets 1..L-1, the first-page section L and up
+	TArray<int32> ObjectNumbers;
+	ObjectNumbers.Init(0, Document.NumObjects() + 1);
+
+	int32 NextNumber = 1;
+	for (int32 PageIndex = 1; PageIndex < NumPages; ++PageIndex)
+	{
+		ObjectNumbers[Document.Pages[PageIndex]] = NextNumber++;
+		ObjectNumbers[Document.PageContents[PageIndex]] = NextNumber++;
+	}
+	for (const int32 Id : OtherIds)
+	{
+		ObjectNumbers[Id] = NextNumber++;
+	}
+
+	const int32 ParameterObject = NextNumber;
+	const int32 CatalogObject = ParameterObject + 1;
+	const int32 HintObject = ParameterObject + 2;
+	ObjectNumbers[Document.Catalog] = CatalogObject;
+
+	NextNumber = HintObject + 1;
+	for (const int32 Id : FirstPageIds)
+	{
+		ObjectNumbers[Id] = NextNumber++;
+	}
+
+	const int32 TotalObjects = NextNumber;
+	const int32 NumFirstPageEntries = TotalObjects - ParameterObject;
+
+	// Serialize every object once with its final number
+	TArray<TArray<uint8>> Serialized;
+	Serialized.SetNum(Document.NumObjects() + 1);
+	for (int32 Id = 1; Id <= Document.NumObjects(); ++Id)
+	{
+		Document.SerializeObject(Id, ObjectNumbers, Serialized[Id]);
+	}
+
+	// Everything before the catalog has a fixed size
+	const int64 HeaderLength = FCStringAnsi::Strlen(Header);
+	FTCHARToUTF8 ParameterPlaceholder(*FormatParameterDictionary(ParameterObject, 0, 0, 0, 0, 0, 0, 0));
+	const int64 ParameterLength = ParameterPlaceholder.Length();
+
+	auto FormatFirstPageTrailer = [&](int64 MainXrefOffset)
+	{
+		return FString::Printf(TEXT("trailer\n<< /Size %d /Root %d 0 R /Prev %10lld >>\nstartxref\n0\n%%%%EOF\n"), TotalObjects, CatalogObject, MainXrefOffset);
+	};
+	const FString FirstXrefHeader = FString::Printf(TEXT("xref\n%d %d\n"), ParameterObject, NumFirstPageEntries);
+	const int64 FirstXrefLength = FirstXrefHeader.Len() + NumFirstPageEntries * 20 + FormatFirstPageTrailer(0).Len();
+
+	const int64 ParameterOffset = HeaderLength;
+	const int64 FirstXrefOffset = ParameterOffset + ParameterLength;
+	const int64 CatalogOffset = FirstXrefOffset + FirstXrefLength;
+	const int64 HintOffset = CatalogOffset + Serialized[Document.Catalog].Num();
+
+	// Lay out the rest as if the hint stream were absent (hint tables use those offsets)
+	TArray<int64> Offsets;
+	Offsets.Init(0, Document.NumObjects() + 1);
+	int64 Position = HintOffset;
+
+	for (const int32 Id : FirstPageIds)
+	{
+		Offsets[Id] = Position;
+		Position += Serialized[Id].Num();
+	}
+	const int64 EndOfFirstPageNoHint = Position;
+
+	for (int32 PageIndex = 1; PageIndex < NumPages; ++PageIndex)
+	{
+		for (const int32 Id : { Document.Pages[PageIndex], Document.PageContents[PageIndex] })
+		{
+			Offsets[Id] = Position;
+			Position += Serialized[Id].Num();
+		}
+	}
+	const int64 EndOfPagesNoHint = Position;
+
+	for (const int32 Id : OtherIds)
+	{
+		Offsets[Id] = Position;
+		Position += Serialized[Id].Num();
+	}
+	const int64 MainXrefNoHint = Position;
+
+	// --- Page offset hint table (Table F.3 / F.4) ---
+	TArray<int64> PageObjectCounts;
+	TArray<int64> PageLengths;
+	TArray<int64> ContentOffsets;
+	TArray<int64> ContentLengths;
+	for (int32 PageIndex = 0; PageIndex < NumPages; ++PageIndex)
+	{
+		const int64 PageStart = Offsets[Document.Pages[PageIndex]];
+		const int64 PageEnd = PageIndex == 0 ? EndOfFirstPageNoHint
+			: PageIndex + 1 < NumPages ? Offsets[Document.Pages[PageIndex + 1]] : EndOfPagesNoHint;
+
+		PageObjectCounts.Add(PageIndex == 0 ? FirstPageIds.Num() : 2);
+		PageLengths.Add(PageEnd - PageStart);
+		ContentOffsets.Add(Offsets[Document.PageContents[PageIndex]] - PageStart);
+		ContentLengths.Add(Serialized[Document.PageContents[PageIndex]].Num());
+	}
+
+	// Shared objects are listed after the first page's own objects in the shared object table
+	const int32 FirstSharedIdentifier = 2;
+	const int32 NumSharedRefs = Document.SharedObjects.Num();
+	const int64 GreatestSharedIdentifier = NumSharedRefs > 0 ? FirstSharedIdentifier + NumSharedRefs - 1 : 0;
+
+	auto MinOf = [](const TArray<int64>& Values) { return FMath::Min(Values); };
+	auto MaxOf = [](const TArray<int64>& Values) { return FMath::Max(Values); };
+
+	TArray<uint8> HintData;
+	{
+		FHintBitWriter Bits(HintData);
+		const int64 MinObjects = MinOf(PageObjectCounts);
+		const int64 MinPageLength = MinOf(PageLengths);
+		const int64 MinContentOffset = MinOf(ContentOffsets);
+		const int64 MinContentLength = MinOf(ContentLengths);
+		const int32 ObjectBits = BitsFor(MaxOf(PageObjectCounts) - MinObjects);
+		const int32 PageLengthBits = BitsFor(MaxOf(PageLengths) - MinPageLength);
+		const int32 ContentOffsetBits = BitsFor(MaxOf(ContentOffsets) - MinContentOffset);
+		const int32 ContentLengthBits = BitsFor(MaxOf(ContentLengths) - MinContentLength);
+		const int32 SharedCountBits = BitsFor(NumPages > 1 ? NumSharedRefs : 0);
+		const int32 SharedIdentifierBits = BitsFor(GreatestSharedIdentifier);
+
+		Bits.Write(MinObjects, 32);
+		Bits.Write(Offsets[Document.Pages[0]], 32);
+		Bits.Write(ObjectBits, 16);
+		Bits.Write(MinPageLength, 32);
+		Bits.Write(PageLengthBits, 16);
+		Bits.Write(MinContentOffset, 32);
+		Bits.Write(ContentOffsetBits, 16);
+		Bits.Write(MinContentLength, 32);
+		Bits.Write(ContentLengthBits, 16);
+		Bits.Write(SharedCountBits, 16);
+		Bits.Write(SharedIdentifierBits, 16);
+		Bits.Write(0, 16);	// Numerator bits: shared objects are not positioned within the content stream
+		Bits.Write(1, 16);	// Denominator
+
+		for (const int64 Count : PageObjectCounts)
+		{
+			Bits.Write(Count - MinObjects, ObjectBits);
+		}
+		Bits.Flush();
+
+		for (const int64 Length : PageLengths)
+		{
+			Bits.Write(Length - MinPageLength, PageLengthBits);
+		}
+		Bits.Flush();
+
+		// The first page's shared objects live in its own section, so it lists none
+		for (int32 PageIndex = 0; PageIndex < NumPages; ++PageIndex)
+		{
+			Bits.Write(PageIndex == 0 ? 0 : NumSharedRefs, SharedCountBits);
+		}
+		Bits.Flush();
+
+		for (int32 PageIndex = 1; PageIndex < NumPages; ++PageIndex)
+		{
+			for (int32 SharedIndex = 0; SharedIndex < NumSharedRefs; ++SharedIndex)
+			{
+				Bits.Write(FirstSharedIdentifier + SharedIndex, SharedIdentifierBits);
+			}
+		}
+		Bits.Flush();
+
+		for (const int64 Offset : ContentOffsets)
+		{
+			Bits.Write(Offset - MinContentOffset, ContentOffsetBits);
+		}
+		Bits.Flush();
+
+		for (const int64 Length : ContentLengths)
+		{
+			Bits.Write(Length - MinContentLength, ContentLengthBits);
+		}
+		Bits.Flush();
+	}
+
+	// --- Shared object hint table (Table F.5 / F.6): one group per first-page-section object ---
+	const int64 SharedTableOffset = HintData.Num();
+	{
+		TArray<int64> GroupLengths;
+		for (const int32 Id : FirstPageIds)
+		{
+			GroupLengths.Add(Serialized[Id].Num());
+		}
+		const int64 MinGroupLength = MinOf(GroupLengths);
+		const int32 GroupLengthBits = BitsFor(MaxOf(GroupLengths) - MinGroupLength);
+
+		FHintBitWriter Bits(HintData);
+		Bits.Write(0, 32);	// No separate shared objects section
+		Bits.Write(0, 32);
+		Bits.Write(FirstPageIds.Num(), 32);
+		Bits.Write(FirstPageIds.Num(), 32);
+		Bits.Write(0, 16);	// Every group is a single object
+		Bits.Write(MinGroupLength, 32);
+		Bits.Write(GroupLengthBits, 16);
+
+		for (const int64 Length : GroupLengths)
+		{
+			Bits.Write(Length - MinGroupLength, GroupLengthBits);
+		}
+		Bits.Flush();
+
+		for (int32 Index = 0; Index < GroupLengths.Num(); ++Index)
+		{
+			Bits.Write(0, 1);	// No MD5 signatures
+		}
+		Bits.Flush();
+	}
+
+	TArray<uint8> HintBytes;
+	Append(HintBytes, FString::Printf(TEXT("%d 0 obj\n<< /Length %d /S %lld >>\nstream\n"), HintObject, HintData.Num(), SharedTableOffset));
+	HintBytes.Append(HintData);
+	Append(HintBytes, TEXT("\nendstream\nendobj\n"));
+	const int64 HintLength = HintBytes.Num();
+
+	// Real positions of everything after the hint stream
+	for (int32 Id = 1; Id <= Document.NumObjects(); ++Id)
+	{
+		if (Id != Document.Catalog)
+		{
+			Offsets[Id] += HintLength;
+		}
+	}
+	Offsets[Document.Catalog] = CatalogOffset;
+
+	const int64 EndOfFirstPage = EndOfFirstPageNoHint + HintLength;
+	const int64 MainXrefOffset = MainXrefNoHint + HintLength;
+
+	// Main xref: object 0 and the main section
+	TArray<int32> IdsByNumber;
+	IdsByNumber.Init(INDEX_NONE, TotalObjects);
+	for (int32 Id = 1; Id <= Document.NumObjects(); ++Id)
+	{
+		IdsByNumber[ObjectNumbers[Id]] = Id;
+	}
+
+	const FString MainXrefHeader = FString::Printf(TEXT("xref\n0 %d\n"), ParameterObject);
+	TArray<uint8> MainXref;
+	Append(MainXref, MainXrefHeader);
+	Append(MainXref, TEXT("0000000000 65535 f \n"));
+	for (int32 Number = 1; Number < ParameterObject; ++Number)
+	{
+		Append(MainXref, FormatXrefEntry(Offsets[IdsByNumber[Number]]));
+	}
+	Append(MainXref, FString::Printf(TEXT("trailer\n<< /Size %d >>\nstartxref\n%lld\n%%%%EOF\n"), ParameterObject, FirstXrefOffset));
+
+	const int64 FileLength = MainXrefOffset + MainXref.Num();
+	const int64 MainXrefFirstEntry = MainXrefOffset + MainXrefHeader.Len() - 1;
+
+	// Assemble
+	OutBytes.Reset();
+	OutBytes.Reserve(FileLength);
+	OutBytes.Append((const uint8*)Header, HeaderLength);
+
+	Append(OutBytes, FormatParameterDictionary(ParameterObject, FileLength, HintOffset, HintLength,
+		ObjectNumbers[Document.Pages[0]], EndOfFirstPage, NumPages, MainXrefFirstEntry));
+	check(OutBytes.Num() == FirstXrefOffset);
+
+	Append(OutBytes, FirstXrefHeader);
+	Append(OutBytes, FormatXrefEntry(ParameterOffset));
+	Append(OutBytes, FormatXrefEntry(CatalogOffset));
+	Append(OutBytes, FormatXrefEntry(HintOffset));
+	for (const int32 Id : FirstPageIds)
+	{
+		Append(OutBytes, FormatXrefEntry(Offsets[Id]));
+	}
+	Append(OutBytes, FormatFirstPageTrailer(MainXrefOffset));
+	check(OutBytes.Num() == CatalogOffset);
+
+	OutBytes.Append(Serialized[Document.Catalog]);
+	OutBytes.Append(HintBytes);
+	for (const int32 Id : FirstPageIds)
+	{
+		OutBytes.Append(Serialized[Id]);
+	}
+	check(OutBytes.Num() == EndOfFirstPage);
+
+	for (int32 PageIndex = 1; PageIndex < NumPages; ++PageIndex)
+	{
+		OutBytes.Append(Serialized[Document.Pages[PageIndex]]);
+		OutBytes.Append(Serialized[Document.PageContents[PageIndex]]);
+	}
+	for (const int32 Id : OtherIds)
+	{
+		OutBytes.Append(Serialized[Id]);
+	}
+	check(OutBytes.Num() == MainXrefOffset);
+
+	OutBytes.Append(MainXref);
+	check(OutBytes.Num() == FileLength);
+}
+
+bool FPDFLinearizer::Validate(const TArray<uint8>& Bytes, FString& OutErrorMessage)
+{
+	using namespace PDFParsing;
+
+	OutErrorMessage.Empty();
+
+	// The linearization dictionary must be the first object in the file
+	const int64 DictObject = FindBytes(Bytes, " obj", 0, 1024);
+	const int64 DictEnd = DictObject != INDEX_NONE ? FindBytes(Bytes, "endobj", DictObject, 1024) : INDEX_NONE;
+	if (DictEnd == INDEX_NONE || FindBytes(Bytes, "/Linearized", DictObject, DictEnd) == INDEX_NONE)
+	{
+		OutErrorMessage = TEXT("No linearization dictionary in the first 1024 bytes");
+		return false;
+	}
+
+	int64 DictStart = DictObject;
+	while (DictStart > 0 && Bytes[DictStart - 1] != '\n' && Bytes[DictStart - 1] != '\r')
+	{
+		--DictStart;
+	}
+	int64 Pos = DictStart;
+	int64 ParameterObject = 0;
+	ReadInteger(Bytes, Pos, ParameterObject);
+
+	int64 FileLength = 0, FirstPageObject = 0, EndOfFirstPage = 0, NumPages = 0, MainXrefEntry = 0;
+	if (!ReadKeyInteger(Bytes, DictObject, DictEnd, "/L", FileLength)
+		|| !ReadKeyInteger(Bytes, DictObject, DictEnd, "/O", FirstPageObject)
+		|| !ReadKeyInteger(Bytes, DictObject, DictEnd, "/E", EndOfFirstPage)
+		|| !ReadKeyInteger(Bytes, DictObject, DictEnd, "/N", NumPages)
+		|| !ReadKeyInteger(Bytes, DictObject, DictEnd, "/T", MainXrefEntry))
+	{
+		OutErrorMessage = TEXT("Linearization dictionary is missing /L, /O, /E, /N or /T");
+		return false;
+	}
+
+	int64 HintOffset = 0, HintLength = 0;
+	const int64 HintArray = FindBytes(Bytes, "/H", DictObject, DictEnd);
+	Pos = HintArray + 2;
+	while (Pos < DictEnd && (IsWhitespace(Bytes[Pos]) || Bytes[Pos] == '['))
+	{
+		++Pos;
+	}
+	if (HintArray == INDEX_NONE || !ReadInteger(Bytes, Pos, HintOffset) || !ReadInteger(Bytes, Pos, HintLength))
+	{
+		OutErrorMessage = TEXT("Linearization dictionary is missing /H");
+		return false;
+	}
+
+	// /L
+	if (FileLength != Bytes.Num())
+	{
+		OutErrorMessage = FString::Printf(TEXT("/L is %lld but the file is %d bytes"), FileLength, Bytes.Num());
+		return false;
+	}
+
+	// First-page xref directly follows the dictionary
+	const int64 FirstXrefOffset = FindObjectEnd(Bytes, DictObject);
+	TMap<int64, int64> FirstPageEntries;
+	int64 FirstPageFirstEntry = 0;
+	int64 FirstTrailer = 0;
+	if (!ReadXrefSection(Bytes, FirstXrefOffset, FirstPageEntries, FirstPageFirstEntry, FirstTrailer))
+	{
+		OutErrorMessage = TEXT("First-page cross-reference table does not follow the linearization dictionary");
+		return false;
+	}
+
+	const int64* ParameterEntry = FirstPageEntries.Find(ParameterObject);
+	if (!ParameterEntry || *ParameterEntry != DictStart)
+	{
+		OutErrorMessage = TEXT("First-page xref does not point at the linearization dictionary");
+		return false;
+	}
+
+	// The file must end with a startxref pointing at the first-page xref
+	const int64 LastStartXref = FindLastBytes(Bytes, "startxref");
+	int64 StartXrefValue = 0;
+	Pos = LastStartXref + 9;
+	if (LastStartXref == INDEX_NONE || !ReadInteger(Bytes, Pos, StartXrefValue) || StartXrefValue != FirstXrefOffset)
+	{
+		OutErrorMessage = TEXT("Final startxref does not point at the first-page cross-reference table");
+		return false;
+	}
+
+	// Main xref via the first-page trailer's /Prev, and /T against its first entry
+	int64 MainXrefOffset = 0;
+	if (!ReadKeyInteger(Bytes, FirstTrailer, FindBytes(Bytes, ">>", FirstTrailer, Bytes.Num()), "/Prev", MainXrefOffset))
+	{
+		OutErrorMessage = TEXT("First-page trailer has no /Prev");
+		return false;
+	}
+
+	TMap<int64, int64> MainEntries;
+	int64 MainFirstEntry = 0;
+	int64 MainTrailer = 0;
+	if (!ReadXrefSection(Bytes, MainXrefOffset, MainEntries, MainFirstEntry, MainTrailer))
+	{
+		OutErrorMessage = FString::Printf(TEXT("/Prev %lld does not point at the main cross-reference table"), MainXrefOffset);
+		return false;
+	}
+
+	if (MainXrefEntry != MainFirstEntry - 1)
+	{
+		OutErrorMessage = FString::Printf(TEXT("/T is %lld but the main xref's first entry starts at %lld"), MainXrefEntry, MainFirstEntry);
+		return false;
+	}
+
+	// Every xref entry must point at the object it names
+	TMap<int64, int64> AllEntries = MainEntries;
+	AllEntries.Append(FirstPageEntries);
+	for (const TPair<int64, int64>& Entry : AllEntries)
+	{
+		if (!IsObjectAt(Bytes, Entry.Value, Entry.Key))
+		{
+			OutErrorMessage = FString::Printf(TEXT("Xref entry for object %lld (offset %lld) is wrong"), Entry.Key, Entry.Value);
+			return false;
+		}
+	}
+
+	// /O must be a page object in the first-page section
+	const int64* FirstPageOffset = FirstPageEntries.Find(FirstPageObject);
+	if (!FirstPageOffset)
+	{
+		OutErrorMessage = TEXT("/O is not in the first-page cross-reference table");
+		return false;
+	}
+	const int64 FirstPageEnd = FindObjectEnd(Bytes, *FirstPageOffset);
+	const int64 PageType = FindBytes(Bytes, "/Type /Page", *FirstPageOffset, FirstPageEnd);
+	if (PageType == INDEX_NONE || Bytes[PageType + 11] == 's')
+	{
+		OutErrorMessage = TEXT("/O is not a page object");
+		return false;
+	}
+
+	// /E is the end of the last first-page-section object
+	int64 LastFirstPageObject = 0;
+	for (const TPair<int64, int64>& Entry : FirstPageEntries)
+	{
+		LastFirstPageObject = FMath::Max(LastFirstPageObject, Entry.Value);
+	}
+	if (FindObjectEnd(Bytes, LastFirstPageObject) != EndOfFirstPage)
+	{
+		OutErrorMessage = FString::Printf(TEXT("/E is %lld but the first page ends at %lld"), EndOfFirstPage, FindObjectEnd(Bytes, LastFirstPageObject));
+		return false;
+	}
+
+	// /N against the number of page objects
+	int64 PageObjects = 0;
+	for (const TPair<int64, int64>& Entry : AllEntries)
+	{
+		const int64 Type = FindBytes(Bytes, "/Type /Page", Entry.Value, FindObjectEnd(Bytes, Entry.Value));
+		PageObjects += (Type != INDEX_NONE && Bytes[Type + 11] != 's') ? 1 : 0;
+	}
+	if (PageObjects != NumPages)
+	{
+		OutErrorMessage = FString::Printf(TEXT("/N is %lld but the file has %lld pages"), NumPages, PageObjects);
+		return false;
+	}
+
+	// /H must span exactly the hint stream object
+	int64 HintObject = 0;
+	Pos = HintOffset;
+	if (!ReadInteger(Bytes, Pos, HintObject) || !FirstPageEntries.Contains(HintObject) || FirstPageEntries[HintObject] != HintOffset
+		|| FindObjectEnd(Bytes, HintOffset) != HintOffset + HintLength)
+	{
+		OutErrorMessage = TEXT("/H does not span the primary hint stream object");
+		return false;
+	}
+
+	// Hint table item 2: first page object location, as if the hint stream were absent
+	const int64 HintData = FindBytes(Bytes, "stream\n", HintOffset, HintOffset + HintLength);
+	if (HintData == INDEX_NONE || HintData + 7 + 8 > HintOffset + HintLength)
+	{
+		OutErrorMessage = TEXT("Primary hint stream has no page offset hint table");
+		return false;
+	}
+	const uint8* Table = Bytes.GetData() + HintData + 7;
+	const int64 HintedFirstPage = ((int64)Table[4] << 24) | ((int64)Table[5] << 16) | ((int64)Table[6] << 8) | (int64)Table[7];
+	const int64 ExpectedFirstPage = *FirstPageOffset > HintOffset ? *FirstPageOffset - HintLength : *FirstPageOffset;
+	if (HintedFirstPage != ExpectedFirstPage)
+	{
+		OutErrorMessage = FString::Printf(TEXT("Page offset hint table locates the first page at %lld, expected %lld"), HintedFirstPage, ExpectedFirstPage);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,143 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PDFObjectWriter.h"
+
+namespace PDFObjectWriter
+{
+	static void Append(TArray<uint8>& Out, const FString& Text)
+	{
+		FTCHARToUTF8 TextUTF8(*Text);
+		Out.Append((const uint8*)TextUTF8.Get(), TextUTF8.Length());
+	}
+
+	static void AppendObjectHeader(TArray<uint8>& Out, int32 ObjectNumber)
+	{
+		ANSICHAR Buffer[32];
+		const int32 Length = FCStringAnsi::Sprintf(Buffer, "%d 0 obj\n", ObjectNumber);
+		Out.Append((const uint8*)Buffer, Length);
+	}
+
+	static void AppendObjectFooter(TArray<uint8>& Out)
+	{
+		Out.Append((const uint8*)"\nendobj\n", 8);
+	}
+}
+
+FPDFObjectWriter::FPDFObjectWriter(TArray<uint8>& InOutput)
+	: Output(InOutput)
+{
+}
+
+void FPDFObjectWriter::WriteHeader()
+{
+	// The comment line with high-bit bytes tells transfer tools the file is binary
+	Write("%PDF-1.4\n%\xE2\xE3\xCF\xD3\n");
+}
+
+void FPDFObjectWriter::Write(const FString& Text)
+{
+	FTCHARToUTF8 TextUTF8(*Text);
+	Write((const uint8*)TextUTF8.Get(), TextUTF8.Length());
+}
+
+void FPDFObjectWriter::Write(const ANSICHAR* Text)
+{
+	Write((const uint8*)Text, FCStringAnsi::Strlen(Text));
+}
+
+void FPDFObjectWriter::Write(const uint8* Data, int64 Num)
+{
+	Output.Append(Data, Num);
+}
+
+void FPDFObjectWriter::ReleaseOutput()
+{
+	NumBytesReleased += Output.Num();
+	Output.Reset();
+}
+
+void FPDFObjectWriter::RecordOffset(int32 ObjectNumber)
+{
+	check(ObjectNumber > 0);
+	const int32 OldNum = ObjectOffsets.Num();
+	if (OldNum <= ObjectNumber)
+	{
+		ObjectOffsets.SetNumUninitialized(ObjectNumber + 1);
+		for (int32 Index = OldNum; Index <= ObjectNumber; ++Index)
+		{
+			ObjectOffsets[Index] = INDEX_NONE;
+		}
+	}
+	ObjectOffsets[ObjectNumber] = Tell();
+}
+
+void FPDFObjectWriter::BeginObject(int32 ObjectNumber)
+{
+	RecordOffset(ObjectNumber);
+	PDFObjectWriter::AppendObjectHeader(Output, ObjectNumber);
+}
+
+void FPDFObjectWriter::EndObject()
+{
+	PDFObjectWriter::AppendObjectFooter(Output);
+}
+
+void FPDFObjectWriter::WriteObject(int32 ObjectNumber, const FString& Body)
+{
+	RecordOffset(ObjectNumber);
+	AppendObject(Output, ObjectNumber, Body);
+}
+
+void FPDFObjectWriter::WriteStreamObject(int32 ObjectNumber, const FString& ExtraEntries, const uint8* Data, int64 Num)
+{
+	RecordOffset(ObjectNumber);
+	AppendStreamObject(Output, ObjectNumber, ExtraEntries, Data, Num);
+}
+
+void FPDFObjectWriter::AppendObject(TArray<uint8>& Out, int32 ObjectNumber, const FString& Body)
+{
+	PDFObjectWriter::AppendObjectHeader(Out, ObjectNumber);
+	PDFObjectWriter::Append(Out, Body);
+	PDFObjectWriter::AppendObjectFooter(Out);
+}
+
+void FPDFObjectWriter::AppendStreamObject(TArray<uint8>& Out, int32 ObjectNumber, const FString& ExtraEntries, const uint8* Data, int64 Num)
+{
+	PDFObjectWriter::AppendObjectHeader(Out, ObjectNumber);
+	if (ExtraEntries.IsEmpty())
+	{
+		PDFObjectWriter::Append(Out, FString::Printf(TEXT("<< /Length %lld >>\nstream\n"), Num));
+	}
+	else
+	{
+		PDFObjectWriter::Append(Out, FString::Printf(TEXT("<< /Length %lld %s >>\nstream\n"), Num, *ExtraEntries));
+	}
+	Out.Append(Data, Num);
+	Out.Append((const uint8*)"\nendstream", 10);
+	PDFObjectWriter::AppendObjectFooter(Out);
+}
+
+void FPDFObjectWriter::WriteXrefAndTrailer(int32 RootObjectNumber)
+{
+	const int64 XrefOffset = Tell();
+	const int32 Size = FMath::Max(ObjectOffsets.Num(), 1);
+
+	Write(FString::Printf(TEXT("xref\n0 %d\n"), Size));
+
+	// Each entry is exactly 20 bytes including the two-character end of line
+	Write("0000000000 65535 f \n");
+	for (int32 ObjectNumber = 1; ObjectNumber < Size; ++ObjectNumber)
+	{
+		const int64 Offset = ObjectOffsets[ObjectNumber];
+		if (Offset == INDEX_NONE)
+		{
+			Write("0000000000 65535 f \n");
+		}
+		else
+		{
+			Write(FString::Printf(TEXT("%010lld 00000 n \n"), Offset));
+		}
+	}
+
+	Write(FString::Printf(TEXT("trailer\n<< /Size %d /Root %d 0 R >>\nstartxref\n%lld\n%%%%EOF\n"), Size, RootObjectNumber, XrefOffset));
+}
@@ -0,0 +1,133 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PDFOutputSink.h"
+#include "AtomicFileWriter.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+
+namespace PDFOutputSink
+{
+	/** How long a socket sink waits for the receiver to close its side after the document is sent */
+	static constexpr double DrainTimeoutSeconds = 2.0;
+}
+
+FPDFFileSink::FPDFFileSink(const FString& InFilePath)
+	: FilePath(InFilePath)
+{
+}
+
+bool FPDFFileSink::Write(TArray<uint8>&& Bytes, FString& OutErrorMessage)
+{
+	// Ensure output directory exists
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	FString PDFDirectory = FPaths::GetPath(FilePath);
+	if (!PlatformFile.DirectoryExists(*PDFDirectory))
+	{
+		if (!PlatformFile.CreateDirectoryTree(*PDFDirectory))
+		{
+			OutErrorMessage = FString::Printf(TEXT("Failed to create directory: %s"), *PDFDirectory);
+			return false;
+		}
+	}
+
+	// Written next to the destination and renamed into place, so readers never see a partial PDF
+	if (!FAtomicFileWriter::SaveArrayToFile(Bytes, FilePath, OutErrorMessage))
+	{
+		OutErrorMessage = FString::Printf(TEXT("Failed to write PDF file: %s (%s)"), *FilePath, *OutErrorMessage);
+		return false;
+	}
+
+	return true;
+}
+
+FPDFMemorySink::FPDFMemorySink(TArray<uint8>& InOutBuffer)
+	: Buffer(InOutBuffer)
+{
+}
+
+bool FPDFMemorySink::Write(TArray<uint8>&& Bytes, FString& OutErrorMessage)
+{
+	Buffer = MoveTemp(Bytes);
+	return true;
+}
+
+FPDFSocketSink::FPDFSocketSink(int32 InPort)
+	: Port(InPort)
+{
+}
+
+FString FPDFSocketSink::Describe() const
+{
+	return FString::Printf(TEXT("localhost:%d"), Port);
+}
+
+bool FPDFSocketSink::Write(TArray<uint8>&& Bytes, FString& OutErrorMessage)
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	if (!SocketSubsystem)
+	{
+		OutErrorMessage = TEXT("No socket subsystem available");
+		return false;
+	}
+
+	TSharedRef<FInternetAddr> Address = SocketSubsystem->CreateInternetAddr();
+	Address->SetLoopbackAddress();
+	Address->SetPort(Port);
+
+	FSocket* Socket = SocketSubsystem->CreateSocket(NAME_Stream, TEXT("PDF output"), Address->GetProtocolType());
+	if (!Socket)
+	{
+		OutErrorMessage = TEXT("Failed to create socket");
+		return false;
+	}
+
+	bool bSuccess = Socket->Connect(*Address);
+	if (!bSuccess)
+	{
+		OutErrorMessage = FString::Printf(TEXT("Failed to connect to %s"), *Describe());
+	}
+
+	// Send may accept fewer bytes than requested, so keep going until everything is out
+	int64 Offset = 0;
+	while (bSuccess && Offset < Bytes.Num())
+	{
+		const int32 ChunkSize = (int32)FMath::Min<int64>(Bytes.Num() - Offset, MAX_int32);
+		int32 BytesSent = 0;
+		if (!Socket->Send(Bytes.GetData() + Offset, ChunkSize, BytesSent) || BytesSent <= 0)
+		{
+			OutErrorMessage = FString::Printf(TEXT("Connection to %s lost after %lld of %d bytes"), *Describe(), Offset, Bytes.Num());
+			bSuccess = false;
+			break;
+		}
+		Offset += BytesSent;
+	}
+
+	// Half-close so the receiver sees end of stream once it has read everything
+	if (bSuccess)
+	{
+		Socket->Shutdown(ESocketShutdownMode::Write);
+
+		// Closing while the receiver's data is unread can turn into a reset that discards the end of
+		// the document before the receiver reads it, so read and drop whatever it sends until it
+		// closes its side or the timeout passes
+		const double Deadline = FPlatformTime::Seconds() + PDFOutputSink::DrainTimeoutSeconds;
+		uint8 Discard[1024];
+		int32 BytesRead = 0;
+		for (double Remaining = PDFOutputSink::DrainTimeoutSeconds; Remaining > 0.0; Remaining = Deadline - FPlatformTime::Seconds())
+		{
+			if (!Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromSeconds(Remaining))
+				|| !Socket->Recv(Discard, sizeof(Discard), BytesRead) || BytesRead <= 0)
+			{
+				break;
+			}
+		}
+	}
+	Socket->Close();
+	SocketSubsystem->DestroySocket(Socket);
+
+	return bSuccess;
+}
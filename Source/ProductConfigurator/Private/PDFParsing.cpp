@@ -0,0 +1,162 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PDFParsing.h"
+
+namespace PDFParsing
+{
+	bool IsWhitespace(uint8 Byte)
+	{
+		return Byte == ' ' || Byte == '\n' || Byte == '\r' || Byte == '\t' || Byte == '\f' || Byte == 0;
+	}
+
+	bool IsDelimiter(uint8 Byte)
+	{
+		return IsWhitespace(Byte) || Byte == '/' || Byte == '[' || Byte == ']' || Byte == '<' || Byte == '>' || Byte == '(' || Byte == ')';
+	}
+
+	int64 FindBytes(const TArray<uint8>& Bytes, const ANSICHAR* Needle, int64 Start, int64 End)
+	{
+		const int64 NeedleLength = FCStringAnsi::Strlen(Needle);
+		End = FMath::Min<int64>(End, Bytes.Num());
+		for (int64 Index = FMath::Max<int64>(Start, 0); Index + NeedleLength <= End; ++Index)
+		{
+			if (FMemory::Memcmp(Bytes.GetData() + Index, Needle, NeedleLength) == 0)
+			{
+				return Index;
+			}
+		}
+		return INDEX_NONE;
+	}
+
+	int64 FindLastBytes(const TArray<uint8>& Bytes, const ANSICHAR* Needle)
+	{
+		const int64 NeedleLength = FCStringAnsi::Strlen(Needle);
+		for (int64 Index = Bytes.Num() - NeedleLength; Index >= 0; --Index)
+		{
+			if (FMemory::Memcmp(Bytes.GetData() + Index, Needle, NeedleLength) == 0)
+			{
+				return Index;
+			}
+		}
+		return INDEX_NONE;
+	}
+
+	bool StartsWith(const TArray<uint8>& Bytes, int64 Offset, const ANSICHAR* Prefix)
+	{
+		const int64 PrefixLength = FCStringAnsi::Strlen(Prefix);
+		return Offset >= 0 && Offset + PrefixLength <= Bytes.Num() && FMemory::Memcmp(Bytes.GetData() + Offset, Prefix, PrefixLength) == 0;
+	}
+
+	bool ReadInteger(const TArray<uint8>& Bytes, int64& Pos, int64& OutValue)
+	{
+		while (Pos < Bytes.Num() && IsWhitespace(Bytes[Pos]))
+		{
+			++Pos;
+		}
+
+		const int64 Start = Pos;
+		OutValue = 0;
+		while (Pos < Bytes.Num() && Bytes[Pos] >= '0' && Bytes[Pos] <= '9')
+		{
+			OutValue = OutValue * 10 + (Bytes[Pos] - '0');
+			++Pos;
+		}
+		return Pos > Start;
+	}
+
+	bool ReadKeyInteger(const TArray<uint8>& Bytes, int64 Start, int64 End, const ANSICHAR* Key, int64& OutValue)
+	{
+		const int64 KeyLength = FCStringAnsi::Strlen(Key);
+		for (int64 Pos = FindBytes(Bytes, Key, Start, End); Pos != INDEX_NONE; Pos = FindBytes(Bytes, Key, Pos + 1, End))
+		{
+			if (Pos + KeyLength < Bytes.Num() && IsDelimiter(Bytes[Pos + KeyLength]))
+			{
+				int64 ValuePos = Pos + KeyLength;
+				return ReadInteger(Bytes, ValuePos, OutValue);
+			}
+		}
+		return false;
+	}
+
+	int64 FindObjectEnd(const TArray<uint8>& Bytes, int64 Offset)
+	{
+		int64 End = FindBytes(Bytes, "endobj", Offset, Bytes.Num());
+		if (End == INDEX_NONE)
+		{
+			return INDEX_NONE;
+		}
+		End += 6;
+		if (End < Bytes.Num() && Bytes[End] == '\r')
+		{
+			++End;
+		}
+		if (End < Bytes.Num() && Bytes[End] == '\n')
+		{
+			++End;
+		}
+		return End;
+	}
+
+	bool IsObjectAt(const TArray<uint8>& Bytes, int64 Offset, int64 ObjectNumber)
+	{
+		int64 Pos = Offset;
+		int64 Number = 0;
+		int64 Generation = 0;
+		return Offset >= 0 && Offset < Bytes.Num() && !IsWhitespace(Bytes[Offset])
+			&& ReadInteger(Bytes, Pos, Number) && Number == ObjectNumber
+			&& ReadInteger(Bytes, Pos, Generation) && Generation == 0
+			&& StartsWith(Bytes, Pos, " obj");
+	}
+
+	bool ReadXrefSection(const TArray<uint8>& Bytes, int64 Offset, TMap<int64, int64>& OutEntries, int64& OutFirstEntry, int64& OutTrailerStart, TSet<int64>* OutFreeEntries)
+	{
+		if (!StartsWith(Bytes, Offset, "xref"))
+		{
+			return false;
+		}
+
+		int64 Pos = Offset + 4;
+		OutFirstEntry = INDEX_NONE;
+		while (true)
+		{
+			int64 SavedPos = Pos;
+			int64 FirstObject = 0;
+			int64 Count = 0;
+			if (!ReadInteger(Bytes, Pos, FirstObject) || !ReadInteger(Bytes, Pos, Count))
+			{
+				OutTrailerStart = SavedPos;
+				return true;
+			}
+
+			// Skip the end of line after the subsection header
+			while (Pos < Bytes.Num() && (Bytes[Pos] == '\r' || Bytes[Pos] == '\n' || Bytes[Pos] == ' '))
+			{
+				++Pos;
+			}
+			if (OutFirstEntry == INDEX_NONE)
+			{
+				OutFirstEntry = Pos;
+			}
+
+			for (int64 Index = 0; Index < Count; ++Index)
+			{
+				if (Pos + 20 > Bytes.Num())
+				{
+					return false;
+				}
+				int64 EntryPos = Pos;
+				int64 EntryOffset = 0;
+				ReadInteger(Bytes, EntryPos, EntryOffset);
+				if (Bytes[Pos + 17] == 'n')
+				{
+					OutEntries.Add(FirstObject + Index, EntryOffset);
+				}
+				else if (OutFreeEntries)
+				{
+					OutFreeEntries->Add(FirstObject + Index);
+				}
+				Pos += 20;
+			}
+		}
+	}
+}
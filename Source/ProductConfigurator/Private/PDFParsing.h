@@ -0,0 +1,47 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Minimal readers for the PDF files this module writes (classic xref tables,
+ * uncompressed object headers). Used to validate linearized output and to
+ * locate the previous revision when appending an incremental update.
+ */
+namespace PDFParsing
+{
+	bool IsWhitespace(uint8 Byte);
+
+	bool IsDelimiter(uint8 Byte);
+
+	/** First occurrence of Needle within [Start, End), or INDEX_NONE */
+	int64 FindBytes(const TArray<uint8>& Bytes, const ANSICHAR* Needle, int64 Start, int64 End);
+
+	/** Last occurrence of Needle in the file, or INDEX_NONE */
+	int64 FindLastBytes(const TArray<uint8>& Bytes, const ANSICHAR* Needle);
+
+	bool StartsWith(const TArray<uint8>& Bytes, int64 Offset, const ANSICHAR* Prefix);
+
+	/** Parse an unsigned integer at Pos (after optional whitespace), advancing Pos */
+	bool ReadInteger(const TArray<uint8>& Bytes, int64& Pos, int64& OutValue);
+
+	/** Find "/Key" within [Start, End) and parse the integer that follows it */
+	bool ReadKeyInteger(const TArray<uint8>& Bytes, int64 Start, int64 End, const ANSICHAR* Key, int64& OutValue);
+
+	/** Offset just past "endobj" and its end-of-line for the object starting at Offset */
+	int64 FindObjectEnd(const TArray<uint8>& Bytes, int64 Offset);
+
+	/** Check that "N 0 obj" starts at Offset */
+	bool IsObjectAt(const TArray<uint8>& Bytes, int64 Offset, int64 ObjectNumber);
+
+	/**
+	 * Parse one xref section at Offset into ObjectNumber -> Offset entries.
+	 *
+	 * @param OutEntries - In-use entries
+	 * @param OutFirstEntry - Offset of the first 20-byte entry
+	 * @param OutTrailerStart - Offset just past the last entry
+	 * @param OutFreeEntries - Optionally receives the numbers of free entries
+	 */
+	bool ReadXrefSection(const TArray<uint8>& Bytes, int64 Offset, TMap<int64, int64>& OutEntries, int64& OutFirstEntry, int64& OutTrailerStart, TSet<int64>* OutFreeEntries = nullptr);
+}
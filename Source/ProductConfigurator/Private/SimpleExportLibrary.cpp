@@ -1,6 +1,7 @@
 // Simple Export Library Implementation
 
 #include "SimpleExportLibrary.h"
+#include "AtomicFileWriter.h"
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
 #include "Misc/DateTime.h"
@@ -33,15 +34,16 @@ void USimpleExportLibrary::ExportStringToJSON(
 		}
 	}
 
-	// Save to file
-	if (FFileHelper::SaveStringToFile(JsonContent, *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	// Save to file; a crash mid-write leaves the previous file rather than a truncated one
+	FString ErrorMessage;
+	if (FAtomicFileWriter::SaveStringToFile(JsonContent, FilePath, ErrorMessage))
 	{
 		Success = true;
 		UE_LOG(LogTemp, Log, TEXT("Configuration exported to: %s"), *FilePath);
 	}
 	else
 	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to save file: %s"), *FilePath);
+		UE_LOG(LogTemp, Error, TEXT("Failed to save file: %s (%s)"), *FilePath, *ErrorMessage);
 	}
 }
 
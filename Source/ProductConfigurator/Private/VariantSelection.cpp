@@ -0,0 +1,310 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "VariantSelection.h"
+#include "VariantSet.h"
+#include "Variant.h"
+#include "LevelVariantSets.h"
+#include "LevelVariantSetsActor.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+bool FVariantSelection::CaptureSelection(ULevelVariantSets* VariantSets, TArray<int32>& OutSelection)
+{
+	OutSelection.Reset();
+
+	if (!VariantSets)
+	{
+		return false;
+	}
+
+	const int32 NumVariantSets = VariantSets->GetNumVariantSets();
+	OutSelection.Reserve(NumVariantSets);
+
+	for (int32 SetIndex = 0; SetIndex < NumVariantSets; ++SetIndex)
+	{
+		int32 ActiveIndex = INDEX_NONE;
+
+		if (UVariantSet* VariantSet = VariantSets->GetVariantSet(SetIndex))
+		{
+			const int32 NumVariants = VariantSet->GetNumVariants();
+			for (int32 VariantIndex = 0; VariantIndex < NumVariants; ++VariantIndex)
+			{
+				UVariant* Variant = VariantSet->GetVariant(VariantIndex);
+				if (Variant && Variant->IsActive())
+				{
+					ActiveIndex = VariantIndex;
+					break;
+				}
+			}
+		}
+
+		OutSelection.Add(ActiveIndex);
+	}
+
+	return true;
+}
+
+bool FVariantSelection::ApplySelection(ALevelVariantSetsActor* LevelVariantSetsActor, const TArray<int32>& Selection, int32& OutNumSwitched, FString& OutErrorMessage)
+{
+	OutNumSwitched = 0;
+	OutErrorMessage.Empty();
+
+	if (!LevelVariantSetsActor)
+	{
+		OutErrorMessage = TEXT("LevelVariantSetsActor is null.");
+		return false;
+	}
+
+	ULevelVariantSets* VariantSets = LevelVariantSetsActor->GetLevelVariantSets(true);
+	if (!VariantSets)
+	{
+		OutErrorMessage = TEXT("No LevelVariantSets asset found in the actor.");
+		return false;
+	}
+
+	if (Selection.Num() != VariantSets->GetNumVariantSets())
+	{
+		OutErrorMessage = FString::Printf(TEXT("Selection has %d entries but the asset has %d variant sets"),
+			Selection.Num(), VariantSets->GetNumVariantSets());
+		return false;
+	}
+
+	// Diff against the live state, so variants switched from Blueprint, the Variant Manager or
+	// dependencies are seen. Only the target variant of each set is checked, not every variant
+	// as CaptureSelection does, so an unchanged set costs one comparison of its captured values.
+	TArray<UVariant*, TInlineAllocator<16>> ChangedVariants;
+	for (int32 SetIndex = 0; SetIndex < Selection.Num(); ++SetIndex)
+	{
+		const int32 TargetIndex = Selection[SetIndex];
+		if (TargetIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		UVariantSet* VariantSet = VariantSets->GetVariantSet(SetIndex);
+		UVariant* Variant = VariantSet ? VariantSet->GetVariant(TargetIndex) : nullptr;
+		if (!Variant)
+		{
+			OutErrorMessage = FString::Printf(TEXT("Variant index %d is out of range for variant set %d"), TargetIndex, SetIndex);
+			return false;
+		}
+
+		if (!Variant->IsActive())
+		{
+			ChangedVariants.Add(Variant);
+		}
+	}
+
+	// Every index was checked above, so a bad selection never leaves the level half switched.
+	// Each changed variant applies its own property values, function calls and dependencies.
+	for (UVariant* Variant : ChangedVariants)
+	{
+		Variant->SwitchOn();
+	}
+
+	OutNumSwitched = ChangedVariants.Num();
+	return true;
+}
+
+bool FVariantSelection::ResolveSelection(ULevelVariantSets* VariantSets, const TArray<FString>& Lines, TArray<int32>& OutSelection, FString& OutErrorMessage)
+{
+	OutSelection.Reset();
+	OutErrorMessage.Empty();
+
+	if (!VariantSets)
+	{
+		OutErrorMessage = TEXT("No LevelVariantSets asset provided.");
+		return false;
+	}
+
+	const int32 NumVariantSets = VariantSets->GetNumVariantSets();
+	OutSelection.Init(INDEX_NONE, NumVariantSets);
+
+	for (const FString& Line : Lines)
+	{
+		FString SetName;
+		FString VariantName;
+		if (!Line.Split(TEXT(": "), &SetName, &VariantName))
+		{
+			OutErrorMessage = FString::Printf(TEXT("Malformed variant entry: %s"), *Line);
+			return false;
+		}
+
+		int32 SetIndex = INDEX_NONE;
+		UVariantSet* VariantSet = nullptr;
+		for (int32 Index = 0; Index < NumVariantSets; ++Index)
+		{
+			UVariantSet* Candidate = VariantSets->GetVariantSet(Index);
+			if (Candidate && Candidate->GetDisplayText().ToString() == SetName)
+			{
+				SetIndex = Index;
+				VariantSet = Candidate;
+				break;
+			}
+		}
+
+		if (!VariantSet)
+		{
+			OutErrorMessage = FString::Printf(TEXT("Variant set not found: %s"), *SetName);
+			return false;
+		}
+
+		if (VariantName == TEXT("None"))
+		{
+			continue;
+		}
+
+		const int32 NumVariants = VariantSet->GetNumVariants();
+		for (int32 VariantIndex = 0; VariantIndex < NumVariants; ++VariantIndex)
+		{
+			UVariant* Variant = VariantSet->GetVariant(VariantIndex);
+			if (Variant && Variant->GetDisplayText().ToString() == VariantName)
+			{
+				OutSelection[SetIndex] = VariantIndex;
+				break;
+			}
+		}
+
+		if (OutSelection[SetIndex] == INDEX_NONE)
+		{
+			OutErrorMessage = FString::Printf(TEXT("Variant not found in set %s: %s"), *SetName, *VariantName);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FVariantSelection::DescribeSelection(ULevelVariantSets* VariantSets, const TArray<int32>& Selection, TArray<FString>& OutLines)
+{
+	if (!VariantSets)
+	{
+		return;
+	}
+
+	const int32 NumVariantSets = FMath::Min(VariantSets->GetNumVariantSets(), Selection.Num());
+	for (int32 SetIndex = 0; SetIndex < NumVariantSets; ++SetIndex)
+	{
+		UVariantSet* VariantSet = VariantSets->GetVariantSet(SetIndex);
+		if (!VariantSet)
+		{
+			continue;
+		}
+
+		FString ActiveVariantName = TEXT("None");
+		if (UVariant* Variant = VariantSet->GetVariant(Selection[SetIndex]))
+		{
+			ActiveVariantName = Variant->GetDisplayText().ToString();
+		}
+
+		OutLines.Add(VariantSet->GetDisplayText().ToString() + TEXT(": ") + ActiveVariantName);
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Configurator.BenchmarkApplyConfiguration [Iterations]
+ * Times ApplySelection for an unchanged selection and for a one-set change, next to a
+ * CaptureSelection and to switching every set on, using the first LevelVariantSetsActor
+ * in the world.
+ */
+static FAutoConsoleCommandWithWorldAndArgs GBenchmarkApplyConfigurationCommand(
+	TEXT("Configurator.BenchmarkApplyConfiguration"),
+	TEXT("Time diff-based ApplyConfiguration against switching every variant set. Usage: Configurator.BenchmarkApplyConfiguration [Iterations]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100;
+
+		TActorIterator<ALevelVariantSetsActor> It(World);
+		ALevelVariantSetsActor* Actor = It ? *It : nullptr;
+		ULevelVariantSets* VariantSets = Actor ? Actor->GetLevelVariantSets(true) : nullptr;
+		if (!VariantSets)
+		{
+			UE_LOG(LogTemp, Error, TEXT("BenchmarkApplyConfiguration: No LevelVariantSetsActor with an asset in the world"));
+			return;
+		}
+
+		TArray<int32> Original;
+		FVariantSelection::CaptureSelection(VariantSets, Original);
+
+		// Pick the first set with two variants to toggle for the one-set-changed case
+		int32 ToggleSet = INDEX_NONE;
+		for (int32 SetIndex = 0; SetIndex < Original.Num() && ToggleSet == INDEX_NONE; ++SetIndex)
+		{
+			UVariantSet* VariantSet = VariantSets->GetVariantSet(SetIndex);
+			if (VariantSet && VariantSet->GetNumVariants() >= 2)
+			{
+				ToggleSet = SetIndex;
+			}
+		}
+
+		TArray<int32> Base = Original;
+		for (int32 SetIndex = 0; SetIndex < Base.Num(); ++SetIndex)
+		{
+			if (Base[SetIndex] == INDEX_NONE && VariantSets->GetVariantSet(SetIndex) && VariantSets->GetVariantSet(SetIndex)->GetNumVariants() > 0)
+			{
+				Base[SetIndex] = 0;
+			}
+		}
+
+		int32 NumSwitched = 0;
+		FString ErrorMessage;
+		FVariantSelection::ApplySelection(Actor, Base, NumSwitched, ErrorMessage);
+
+		// Unchanged: every call should be a pure diff with nothing switched
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			FVariantSelection::ApplySelection(Actor, Base, NumSwitched, ErrorMessage);
+		}
+		const double UnchangedUs = (FPlatformTime::Seconds() - StartTime) * 1e6 / Iterations;
+
+		// Reading every set's active variant, which the diff avoids by checking only the targets
+		TArray<int32> Captured;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			FVariantSelection::CaptureSelection(VariantSets, Captured);
+		}
+		const double CaptureUs = (FPlatformTime::Seconds() - StartTime) * 1e6 / Iterations;
+
+		// One set changed: alternate a single set between two variants
+		double OneChangedUs = 0.0;
+		if (ToggleSet != INDEX_NONE)
+		{
+			TArray<int32> Toggled = Base;
+			Toggled[ToggleSet] = Base[ToggleSet] == 0 ? 1 : 0;
+
+			StartTime = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				FVariantSelection::ApplySelection(Actor, (Iteration & 1) ? Base : Toggled, NumSwitched, ErrorMessage);
+			}
+			OneChangedUs = (FPlatformTime::Seconds() - StartTime) * 1e6 / Iterations;
+		}
+
+		// Reference: the Blueprint approach of switching on every set
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			for (int32 SetIndex = 0; SetIndex < Base.Num(); ++SetIndex)
+			{
+				if (Base[SetIndex] != INDEX_NONE)
+				{
+					Actor->SwitchOnVariantByIndex(SetIndex, Base[SetIndex]);
+				}
+			}
+		}
+		const double SwitchAllUs = (FPlatformTime::Seconds() - StartTime) * 1e6 / Iterations;
+
+		FVariantSelection::ApplySelection(Actor, Original, NumSwitched, ErrorMessage);
+
+		UE_LOG(LogTemp, Display, TEXT("BenchmarkApplyConfiguration: %d sets, %d iterations"), Base.Num(), Iterations);
+		UE_LOG(LogTemp, Display, TEXT("  Unchanged:                  %8.2f us"), UnchangedUs);
+		UE_LOG(LogTemp, Display, TEXT("  CaptureSelection (no-op):   %8.2f us"), CaptureUs);
+		UE_LOG(LogTemp, Display, TEXT("  One set changed:            %8.2f us"), OneChangedUs);
+		UE_LOG(LogTemp, Display, TEXT("  Switch all sets:            %8.2f us"), SwitchAllUs);
+	}));
+
+#endif
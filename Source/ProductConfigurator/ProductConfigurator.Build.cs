@@ -21,7 +21,9 @@ public class ProductConfigurator : ModuleRules
 		PrivateDependencyModuleNames.AddRange(new string[] 
 		{
 			"Slate",
-			"SlateCore"
+			"SlateCore",
+			"Sockets",
+			"ImageWrapper"
 		});
 	}
 }
@@ -0,0 +1,70 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IFileHandle;
+
+/**
+ * Crash-safe file writes for exports.
+ *
+ * Data goes to a temporary file next to the destination, which is flushed to disk
+ * and then renamed over the destination; the directory is synced afterwards so the
+ * rename itself survives a power loss. Readers therefore see either the previous
+ * file or the complete new one, never a truncated one.
+ *
+ * File data is synced with one fsync per file, on the writing thread, so concurrent
+ * exports sync their data in parallel but each still pays for its own file. Only the
+ * renames and directory syncs are batched: while one thread is syncing the directory,
+ * files finished on other threads queue up and are renamed together before the next
+ * directory sync, so concurrent exports into the same directory share one directory sync.
+ * Data syncs are deliberately not batched; a file system wide sync (syncfs) would make
+ * every export wait for unrelated I/O.
+ */
+class PRODUCTCONFIGURATOR_API FAtomicFileWriter
+{
+public:
+	/**
+	 * Atomically replace a file with the given bytes.
+	 * The directory must already exist.
+	 *
+	 * @param Bytes - New file contents
+	 * @param FilePath - Destination file
+	 * @param OutErrorMessage - Error message if the file could not be written
+	 * @return true if the new contents are durably in place
+	 */
+	static bool SaveArrayToFile(const TArray<uint8>& Bytes, const FString& FilePath, FString& OutErrorMessage);
+
+	/**
+	 * Atomically replace a file with text encoded as UTF-8 without a BOM.
+	 */
+	static bool SaveStringToFile(const FString& Text, const FString& FilePath, FString& OutErrorMessage);
+
+	/**
+	 * Start a file too large to build in memory. Write to the returned handle, then
+	 * pass it to CommitStream to move the file into place, or to DiscardStream to give up.
+	 *
+	 * @param FilePath - Destination file (its directory must exist)
+	 * @param OutTempPath - Temporary file the handle writes to
+	 * @param OutErrorMessage - Error message if the temporary file could not be created
+	 * @return Handle to the temporary file, or null on error
+	 */
+	static IFileHandle* OpenStream(const FString& FilePath, FString& OutTempPath, FString& OutErrorMessage);
+
+	/** Flush, close, rename and sync a file started with OpenStream; takes ownership of the handle */
+	static bool CommitStream(IFileHandle* Handle, const FString& TempPath, const FString& FilePath, FString& OutErrorMessage);
+
+	/** Close and delete a file started with OpenStream */
+	static void DiscardStream(IFileHandle* Handle, const FString& TempPath);
+
+	/**
+	 * Counters since startup.
+	 *
+	 * @param OutNumFilesCommitted - Files renamed into place
+	 * @param OutNumFileSyncs - Temporary files flushed (one per file, on the writing thread)
+	 * @param OutNumBatches - Rename batches (each renames the files queued at that point)
+	 * @param OutNumDirectorySyncs - Directory syncs (one per directory per batch)
+	 */
+	static void GetCommitStats(int64& OutNumFilesCommitted, int64& OutNumFileSyncs, int64& OutNumBatches, int64& OutNumDirectorySyncs);
+};
@@ -28,6 +28,18 @@ struct FConfigurationData
 
 	UPROPERTY(BlueprintReadWrite, Category = "Configuration")
 	FString SelectedCamera;
+
+	/** Compact code that restores this configuration (see FConfigurationShareCode) */
+	UPROPERTY(BlueprintReadWrite, Category = "Configuration")
+	FString ShareCode;
+
+	/** Picture of the configured product (absolute, or relative to the project Content directory) */
+	UPROPERTY(BlueprintReadWrite, Category = "Configuration")
+	FString PreviewImagePath;
+
+	/** Swatch images of the chosen materials (absolute, or relative to the project Content directory) */
+	UPROPERTY(BlueprintReadWrite, Category = "Configuration")
+	TArray<FString> SwatchImagePaths;
 };
 
 /**
@@ -105,6 +117,115 @@ public:
 		FString& ErrorMessage
 	);
 
+	/**
+	 * Add a configuration to an existing PDF as a new revision instead of writing a new file.
+	 * Only the parts of the document that changed are appended; earlier revisions stay in the file.
+	 * Creates the PDF if it does not exist yet.
+	 * @param ConfigData Configuration to render
+	 * @param PDFPath PDF file to update (e.g. the PDFOutputPath of an earlier export)
+	 * @param Success Whether the PDF now shows the configuration
+	 * @param NumObjectsWritten Number of PDF objects in the new revision (0 if nothing changed)
+	 * @param ErrorMessage Error message if the update failed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Configuration|Export")
+	static void AppendConfigurationToPDF(
+		const FConfigurationData& ConfigData,
+		const FString& PDFPath,
+		bool& Success,
+		int32& NumObjectsWritten,
+		FString& ErrorMessage
+	);
+
+	/**
+	 * Put every configuration exported in a date range into one PDF catalog, oldest first.
+	 * Reads the JSON files in Saved/Configurations; each configuration starts on a new page
+	 * and gets a bookmark. Files last modified before From are skipped without being read.
+	 * Only each file's export time and path are kept while sorting; configurations are then
+	 * read one at a time and their pages written as soon as they are laid out, so memory use
+	 * does not grow with the number of configurations.
+	 * @param From Earliest export time to include (local time, like the Timestamp field)
+	 * @param To Latest export time to include
+	 * @param CatalogName File name for the catalog without extension (optional)
+	 * @param Success Whether the catalog was written
+	 * @param PDFOutputPath Path to the generated PDF file
+	 * @param NumConfigurations Number of configurations in the catalog
+	 * @param ErrorMessage Error message if the export failed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Configuration|Export")
+	static void ExportCatalogToPDF(
+		const FDateTime& From,
+		const FDateTime& To,
+		const FString& CatalogName,
+		bool& Success,
+		FString& PDFOutputPath,
+		int32& NumConfigurations,
+		FString& ErrorMessage
+	);
+
+	/**
+	 * Restore a saved configuration on a LevelVariantSetsActor.
+	 * Only VariantSets whose saved variant is not already active in the level are switched.
+	 * Uses ConfigData.ShareCode when present, otherwise resolves SelectedVariants by name.
+	 * @param LevelVariantSetsActor The actor containing the VariantSet data
+	 * @param ConfigData Configuration to restore (e.g. loaded from an exported JSON file)
+	 * @param Success Whether the configuration was applied
+	 * @param NumSetsSwitched Number of VariantSets that actually changed
+	 * @param ErrorMessage Error message if the configuration does not match the actor
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Configuration|Apply")
+	static void ApplyConfiguration(
+		class ALevelVariantSetsActor* LevelVariantSetsActor,
+		const FConfigurationData& ConfigData,
+		bool& Success,
+		int32& NumSetsSwitched,
+		FString& ErrorMessage
+	);
+
+	/**
+	 * Build a share code for the variants currently active on a LevelVariantSetsActor
+	 * @param LevelVariantSetsActor The actor containing the VariantSet data
+	 * @param Success Whether the code was built
+	 * @param ShareCode Short base32 code describing the selection
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Configuration|ShareCode")
+	static void GetShareCode(
+		class ALevelVariantSetsActor* LevelVariantSetsActor,
+		bool& Success,
+		FString& ShareCode
+	);
+
+	/**
+	 * Decode a share code into configuration data without touching the level
+	 * @param LevelVariantSetsActor The actor whose VariantSets the code was created for
+	 * @param ShareCode Code produced by GetShareCode
+	 * @param ConfigData Decoded configuration (SelectedVariants and ShareCode are filled in)
+	 * @param Success Whether the code was valid for this actor
+	 * @param ErrorMessage Error message if decoding failed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Configuration|ShareCode")
+	static void DecodeShareCode(
+		class ALevelVariantSetsActor* LevelVariantSetsActor,
+		const FString& ShareCode,
+		FConfigurationData& ConfigData,
+		bool& Success,
+		FString& ErrorMessage
+	);
+
+	/**
+	 * Switch the level to the configuration described by a share code
+	 * @param LevelVariantSetsActor The actor containing the VariantSet data
+	 * @param ShareCode Code produced by GetShareCode
+	 * @param Success Whether the code was applied
+	 * @param ErrorMessage Error message if the code was invalid
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Configuration|ShareCode")
+	static void ApplyShareCode(
+		class ALevelVariantSetsActor* LevelVariantSetsActor,
+		const FString& ShareCode,
+		bool& Success,
+		FString& ErrorMessage
+	);
+
 	/**
 	 * Get current timestamp as formatted string
 	 * @return Timestamp string in YYYY-MM-DD_HH-MM-SS format
@@ -0,0 +1,71 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ULevelVariantSets;
+
+/**
+ * Compact share codes for a variant selection.
+ *
+ * The selected index of every VariantSet is packed as one mixed-radix integer
+ * (radix = variant count + 1, digit 0 meaning "nothing selected"), prefixed by a
+ * format version and a hash of the VariantSet layout, suffixed by a checksum, and
+ * rendered as Crockford base32. A guitar with a handful of sets fits in ~12 characters.
+ */
+class PRODUCTCONFIGURATOR_API FConfigurationShareCode
+{
+public:
+	/** Bumped whenever the byte layout of a share code changes */
+	static constexpr uint8 FormatVersion = 1;
+
+	/**
+	 * Describes how selections of one LevelVariantSets asset are packed.
+	 * Codes built against a different set/variant layout are rejected on decode.
+	 */
+	struct FSchema
+	{
+		/** Hash of every VariantSet and Variant display name, in order */
+		uint16 SchemaHash = 0;
+
+		/** Number of digits per set (variant count + 1) */
+		TArray<uint32> Radices;
+
+		/** Bytes needed to store the largest mixed-radix value */
+		int32 ValueBytes = 0;
+	};
+
+	/**
+	 * Build the packing schema for a LevelVariantSets asset.
+	 */
+	static bool BuildSchema(ULevelVariantSets* VariantSets, FSchema& OutSchema);
+
+	/**
+	 * Encode a selection (one variant index per set) as a share code.
+	 *
+	 * @param Schema - Schema of the asset the selection belongs to
+	 * @param Selection - One variant index per set (INDEX_NONE for no selection)
+	 * @param OutShareCode - Base32 share code
+	 * @param OutErrorMessage - Error message if encoding fails
+	 * @return true if the code was built
+	 */
+	static bool Encode(const FSchema& Schema, const TArray<int32>& Selection, FString& OutShareCode, FString& OutErrorMessage);
+
+	/**
+	 * Decode a share code back into a selection.
+	 * Hyphens, spaces and lowercase letters are accepted, as are the usual
+	 * Crockford substitutions (O for 0, I/L for 1).
+	 *
+	 * @param Schema - Schema of the asset the code is applied to
+	 * @param ShareCode - Base32 share code
+	 * @param OutSelection - One variant index per set (INDEX_NONE for no selection)
+	 * @param OutErrorMessage - Error message if the code is malformed or for another layout
+	 * @return true if the code was decoded
+	 */
+	static bool Decode(const FSchema& Schema, const FString& ShareCode, TArray<int32>& OutSelection, FString& OutErrorMessage);
+
+private:
+	static FString BytesToBase32(const TArray<uint8>& Bytes);
+	static bool Base32ToBytes(const FString& Code, TArray<uint8>& OutBytes);
+};
@@ -0,0 +1,136 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PDFGenerator.h"
+
+struct FConfigurationData;
+class FPDFObjectWriter;
+class IFileHandle;
+
+/**
+ * Streams many configurations into one PDF ("catalog").
+ *
+ * Fonts, images and the resource dictionary are written once and shared by every
+ * page; embedded fonts are subset to the glyphs of the whole catalog. Each
+ * configuration is laid out, serialized and written to disk as soon as it is
+ * added, so memory is bounded by the largest single configuration plus a few
+ * bytes per page. Finish() adds a bookmark outline with one entry per
+ * configuration and a /Dests name tree, so configurations can be opened by name
+ * (e.g. "Catalog.pdf#nameddest=Red_Sport").
+ *
+ * The file appears at its final path only when Finish() succeeds (see FAtomicFileWriter).
+ */
+class PRODUCTCONFIGURATOR_API FPDFCatalogWriter
+{
+public:
+	/**
+	 * @param InLayout - Layout used for every configuration
+	 * @param InOptions - Serialization options (bLinearize is ignored; a linearized file cannot be streamed)
+	 */
+	FPDFCatalogWriter(TSharedRef<const FPDFLayoutProgram> InLayout, const FPDFWriteOptions& InOptions = FPDFWriteOptions());
+	~FPDFCatalogWriter();
+
+	/**
+	 * Start the catalog file, creating its directory if needed.
+	 *
+	 * @param PdfFilePath - Full path where the catalog should be saved
+	 * @param OutErrorMessage - Error message if the file could not be created
+	 * @return true if configurations can be added
+	 */
+	bool Open(const FString& PdfFilePath, FString& OutErrorMessage);
+
+	/**
+	 * Lay out one configuration and write its pages.
+	 *
+	 * @param ConfigData - Configuration to render
+	 * @param OutErrorMessage - Error message if the pages could not be written
+	 * @return false if writing failed; the catalog is then discarded
+	 */
+	bool AddConfiguration(const FConfigurationData& ConfigData, FString& OutErrorMessage);
+
+	/**
+	 * Write the shared resources, page tree, outline and name tree, then move the file into place.
+	 *
+	 * @param OutErrorMessage - Error message if the file could not be completed
+	 * @return true if the catalog is complete at its final path
+	 */
+	bool Finish(FString& OutErrorMessage);
+
+	int32 NumConfigurations() const { return Entries.Num(); }
+	int32 NumPages() const { return TotalPages; }
+
+	/**
+	 * Encode a PDF text string (used for outline titles): a literal string if the text
+	 * is printable ASCII, otherwise UTF-16BE hex with a byte order mark. Control characters
+	 * in literals are written as escapes so they cannot end or corrupt the string.
+	 */
+	static FString EncodeTextString(const FString& Text);
+
+private:
+	/** What the outline and name tree need to know about a configuration once its pages are on disk */
+	struct FEntry
+	{
+		FString Title;
+		FString DestinationName;
+		int32 FirstPage = 0;
+	};
+
+	int32 AllocateObject() { return NextObjectNumber++; }
+	void WriteImages(const FConfigurationData& ConfigData, TMap<FString, FPDFLayoutImage>& OutImages);
+	void WriteEmbeddedFont(int32 FontIndex);
+	bool FlushOutput();
+	void Discard();
+	FString MakeDestinationName(const FConfigurationData& ConfigData);
+	void WritePageTree();
+	int32 WriteOutline();
+	int32 WriteNameTree(const TArray<int32>& SortedEntries);
+
+	TSharedRef<const FPDFLayoutProgram> Layout;
+	FPDFWriteOptions Options;
+
+	FString FilePath;
+	FString TempPath;
+	IFileHandle* FileHandle = nullptr;
+
+	/** Bytes not yet written to FileHandle */
+	TArray<uint8> Buffer;
+	TUniquePtr<FPDFObjectWriter> Writer;
+
+	int32 NextObjectNumber = 1;
+	int32 CatalogObject = 0;
+	int32 PageTreeObject = 0;
+	int32 ResourcesObject = 0;
+	TArray<int32> FontObjects;
+
+	/** Glyphs drawn so far with each embedded font; the fonts are subset once, by Finish */
+	FPDFGlyphUsage UsedGlyphs;
+
+	/** An image already in the file; the weak pointer tells whether the cache still holds the same object */
+	struct FWrittenImage
+	{
+		TWeakPtr<const FPDFImage> Image;
+		FPDFLayoutImage Resource;
+	};
+
+	/** Images already in the file, by path as it appears in the configuration and by cached image */
+	TMap<FString, FPDFLayoutImage> ImagesByPath;
+	TMap<const FPDFImage*, FWrittenImage> ImagesByContent;
+	FString ImageResources;
+	int32 NumImages = 0;
+
+	/** A /Pages node; the ones of configurations are written by Finish, once their parents are allocated */
+	struct FConfigurationNode
+	{
+		int32 Object = 0;
+		FString Kids;
+		int32 NumPages = 0;
+	};
+
+	/** /Pages node of every configuration, in order */
+	TArray<FConfigurationNode> ConfigurationNodes;
+	TArray<FEntry> Entries;
+	TSet<FString> DestinationNames;
+	int32 TotalPages = 0;
+};
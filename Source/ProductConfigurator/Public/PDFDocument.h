@@ -0,0 +1,86 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FPDFObjectWriter;
+
+/**
+ * In-memory PDF object graph.
+ *
+ * Objects refer to each other through Ref() placeholders instead of object
+ * numbers, so each writer can pick its own numbering (a linearized file numbers
+ * the first page separately from the rest of the document).
+ * Ids start at 1 and, for a plain write, are used as the object numbers.
+ */
+class PRODUCTCONFIGURATOR_API FPDFDocument
+{
+public:
+	struct FObject
+	{
+		/** Dictionary or value, possibly containing Ref() placeholders */
+		FString Body;
+
+		/** Stream data, written after Body when bIsStream is set */
+		TArray<uint8> Stream;
+
+		/** Extra stream dictionary entries (e.g. "/Filter /FlateDecode"); /Length is added automatically */
+		FString StreamEntries;
+
+		bool bIsStream = false;
+
+		/**
+		 * Name that identifies the object across revisions of a document (e.g. "Page/2/Contents").
+		 * FPDFIncrementalUpdate keeps an object's number for as long as its key is used; objects
+		 * without a key get a new number in every revision.
+		 */
+		FString Key;
+	};
+
+	/** Add a non-stream object and return its id */
+	int32 AddObject(const FString& Body);
+
+	/** Add a stream object and return its id */
+	int32 AddStreamObject(const FString& StreamEntries, TArray<uint8>&& Stream);
+
+	/** Add an empty object to be filled in once its references are known */
+	int32 ReserveObject();
+
+	FObject& GetObject(int32 Id) { return Objects[Id - 1]; }
+	const FObject& GetObject(int32 Id) const { return Objects[Id - 1]; }
+	int32 NumObjects() const { return Objects.Num(); }
+
+	/** Placeholder for an indirect reference ("N 0 R") to an object */
+	static FString Ref(int32 Id);
+
+	/**
+	 * Replace every Ref() placeholder in Body with "N 0 R".
+	 * @param ObjectNumbers - Object number per id (index 0 unused), or empty to use the ids themselves
+	 */
+	static FString ResolveReferences(const FString& Body, const TArray<int32>& ObjectNumbers);
+
+	/**
+	 * Append one complete "N 0 obj ... endobj" record.
+	 * @param ObjectNumbers - Object number per id (index 0 unused), or empty to use the ids themselves
+	 */
+	void SerializeObject(int32 Id, const TArray<int32>& ObjectNumbers, TArray<uint8>& OutBytes) const;
+
+	/** Write every object numbered by id, followed by the xref table and trailer */
+	void Write(FPDFObjectWriter& Writer) const;
+
+	/** Document catalog */
+	int32 Catalog = INDEX_NONE;
+
+	/** Page object of every page, in order */
+	TArray<int32> Pages;
+
+	/** Content stream of every page, in order */
+	TArray<int32> PageContents;
+
+	/** Objects referenced by more than one page (resources, fonts, images) */
+	TArray<int32> SharedObjects;
+
+private:
+	TArray<FObject> Objects;
+};
@@ -0,0 +1,185 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+class FPDFDocument;
+
+/**
+ * A glyph subset of an embedded font, encoded as the streams and dictionary entries
+ * of a PDF Type0 font.
+ *
+ * Content streams draw with the glyph ids of the full font (/Identity-H, so the
+ * character ids are the original glyph ids); the CIDToGIDMap points them at the
+ * renumbered glyphs of the subset. Pages can therefore be written before the
+ * document's glyph set is known.
+ */
+struct PRODUCTCONFIGURATOR_API FPDFFontSubset
+{
+	/** Glyph ids drawn by the document, sorted */
+	TArray<uint16> Glyphs;
+
+	/** PostScript name with the subset tag (e.g. KQZWPT+Lato-Regular); no tag when the whole font is embedded */
+	FString BaseFont;
+
+	struct FStream
+	{
+		TArray<uint8> Bytes;
+
+		/** Stream dictionary entries other than /Length (e.g. "/Filter /FlateDecode") */
+		FString Entries;
+	};
+
+	/** TrueType program of the subset (with /Length1), CIDToGIDMap and ToUnicode CMap, Flate-compressed */
+	FStream FontFile;
+	FStream CIDToGIDMap;
+	FStream ToUnicode;
+
+	/** /W array contents (advance widths of the drawn glyphs, in 1/1000 em) */
+	FString Widths;
+
+	/** FontDescriptor entries other than /FontName and /FontFile2 */
+	FString DescriptorEntries;
+
+	/**
+	 * Add the Type0 font and the objects it refers to (CIDFontType2, FontDescriptor,
+	 * FontFile2, CIDToGIDMap and ToUnicode) to a document.
+	 *
+	 * @param OutObjects - Ids of every added object are appended here (e.g. FPDFDocument::SharedObjects)
+	 * @param Key - FPDFDocument::FObject::Key of the font dictionary; the other objects get keys derived from it
+	 * @return Id of the Type0 font dictionary
+	 */
+	int32 AddToDocument(FPDFDocument& Document, TArray<int32>& OutObjects, const FString& Key = FString()) const;
+};
+
+/**
+ * A parsed TrueType font (.ttf, or .otf with TrueType outlines).
+ *
+ * Parsing reads the tables, metrics and character map once; drawing text and
+ * subsetting only look them up. Fonts with PostScript (CFF) outlines and fonts
+ * whose license forbids embedding are rejected. Text is mapped one character to
+ * one glyph through the cmap, without kerning or shaping.
+ */
+class PRODUCTCONFIGURATOR_API FPDFTrueTypeFont
+{
+public:
+	/**
+	 * Parse a font file.
+	 *
+	 * @param FileBytes - Contents of the font file; kept by the font for subsetting
+	 * @param OutErrorMessage - Error message if the file is not a usable TrueType font
+	 * @return The parsed font, or null on error
+	 */
+	static TSharedPtr<FPDFTrueTypeFont> Parse(TArray<uint8>&& FileBytes, FString& OutErrorMessage);
+
+	/** Glyph id of a Unicode code point (0, the .notdef glyph, if the font has none) */
+	uint16 GetGlyph(uint32 CodePoint) const;
+
+	/**
+	 * Append text as hex glyph ids for a <...> Tj string, four digits per character.
+	 * Characters the font has no glyph for are drawn as .notdef; each one is logged
+	 * once per font.
+	 *
+	 * @param OutGlyphs - Glyph ids drawn are added here
+	 */
+	void AppendGlyphs(const FString& Text, TArray<uint8>& OutHex, TSet<uint16>& OutGlyphs) const;
+
+	/**
+	 * Subset the font to the glyphs a document draws. The last few subsets are cached,
+	 * so documents drawing the same glyphs share one subset.
+	 */
+	TSharedRef<const FPDFFontSubset> GetSubset(const TSet<uint16>& Glyphs) const;
+
+	/**
+	 * Build a TrueType program containing only the given glyphs, glyph 0 and the
+	 * components of composite glyphs, renumbered from 0 in ascending order.
+	 *
+	 * @param OutNewToOld - Original glyph id of every glyph in the subset
+	 */
+	void BuildSubsetProgram(const TArray<uint16>& Glyphs, TArray<uint8>& OutProgram, TArray<uint16>& OutNewToOld) const;
+
+	const FString& GetPostScriptName() const { return PostScriptName; }
+	int32 NumGlyphs() const { return GlyphOffsets.Num() - 1; }
+	int32 NumMappedCharacters() const { return CharToGlyph.Num(); }
+
+	/** Subsets kept by GetSubset */
+	static constexpr int32 MaxCachedSubsets = 16;
+
+private:
+	struct FTable
+	{
+		int32 Offset = 0;
+		int32 Length = 0;
+	};
+
+	bool ParseCharacterMap(const FTable& Cmap, FString& OutErrorMessage);
+	void ParseNames(const FTable& Name);
+	TSharedRef<const FPDFFontSubset> BuildSubset(TArray<uint16>&& Glyphs) const;
+	int32 ScaleToPDF(int32 FontUnits) const;
+
+	/** Contents of the font file */
+	TArray<uint8> Data;
+
+	/** Tables copied into subsets (cvt, fpgm and prep are optional and may be empty) */
+	FTable Head;
+	FTable Hhea;
+	FTable Maxp;
+	FTable Hmtx;
+	FTable Glyf;
+	FTable Cvt;
+	FTable Fpgm;
+	FTable Prep;
+
+	FString PostScriptName;
+	int32 UnitsPerEm = 1000;
+	int32 XMin = 0, YMin = 0, XMax = 0, YMax = 0;
+	int32 Ascent = 0;
+	int32 Descent = 0;
+	int32 CapHeight = 0;
+	float ItalicAngle = 0.0f;
+	bool bFixedPitch = false;
+
+	/** License (OS/2 fsType) allows embedding only the complete font */
+	bool bNoSubsetting = false;
+
+	/** Start of every glyph in glyf, plus the end of the last one */
+	TArray<uint32> GlyphOffsets;
+	TArray<uint16> AdvanceWidths;
+	TArray<int16> LeftSideBearings;
+
+	TMap<uint32, uint16> CharToGlyph;
+
+	/** Lowest code point mapped to each glyph (0 if none), for ToUnicode */
+	TArray<uint32> GlyphToChar;
+
+	/** Most recently used first */
+	mutable FCriticalSection SubsetLock;
+	mutable TArray<TSharedRef<const FPDFFontSubset>> RecentSubsets;
+
+	/** Code points already reported as missing by AppendGlyphs */
+	mutable FCriticalSection MissingCharactersLock;
+	mutable TSet<uint32> MissingCharacters;
+};
+
+/**
+ * Process-wide cache of parsed fonts, keyed by file path.
+ * A font is parsed on first use and again only when its file's timestamp changes,
+ * so exports never parse font files.
+ */
+class PRODUCTCONFIGURATOR_API FPDFFontCache
+{
+public:
+	/**
+	 * Get a parsed font.
+	 *
+	 * @param FilePath - Full path to a TrueType font file
+	 * @param OutErrorMessage - Error message if the file is missing or not a usable font
+	 * @return The parsed font, or null on error
+	 */
+	static TSharedPtr<const FPDFTrueTypeFont> Load(const FString& FilePath, FString& OutErrorMessage);
+
+	/** Drop every cached font */
+	static void Empty();
+};
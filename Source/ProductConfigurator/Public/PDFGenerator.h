@@ -4,10 +4,61 @@
 
 #include "CoreMinimal.h"
 #include "Containers/UnrealString.h"
+#include "PDFLayoutTemplate.h"
+#include "PDFImage.h"
+
+struct FConfigurationData;
+class FPDFDocument;
+class IPDFOutputSink;
+
+/**
+ * Options controlling how a PDF document is serialized.
+ */
+struct FPDFWriteOptions
+{
+	/** Flate-compress page content streams */
+	bool bCompressStreams = false;
+
+	/** Maximum number of worker threads used to serialize pages (0 = use all cores, 1 = serial) */
+	int32 MaxThreads = 0;
+
+	/** Write a linearized ("Fast Web View") file so viewers can show page one before the download completes */
+	bool bLinearize = false;
+};
+
+/**
+ * Finished content stream of one page.
+ */
+struct FPDFPageStream
+{
+	TArray<uint8> Bytes;
+
+	/** Bytes are Flate-compressed */
+	bool bCompressed = false;
+
+	/** Glyphs the page draws with embedded fonts */
+	FPDFGlyphUsage Glyphs;
+};
+
+/**
+ * Images embedded in one document.
+ */
+struct FPDFDocumentImages
+{
+	/** Distinct images, in resource order (Im1, Im2, ...) */
+	TArray<TSharedPtr<const FPDFImage>> Images;
+
+	/** Path each image was first loaded from, parallel to Images (names the image across revisions of a file) */
+	TArray<FString> Paths;
+
+	/** Resource for every image path in the configuration that could be loaded */
+	TMap<FString, FPDFLayoutImage> ByPath;
+};
 
 /**
  * Pure C++ PDF generator using PDF 1.4 specification.
  * No external dependencies - works in packaged builds.
+ * Page content comes from the layout template (see FPDFLayoutTemplateCache).
  */
 class PRODUCTCONFIGURATOR_API FPDFGenerator
 {
@@ -18,29 +69,130 @@ public:
 	 * @param JsonFilePath - Full path to the JSON configuration file
 	 * @param PdfFilePath - Full path where the PDF should be saved
 	 * @param OutErrorMessage - Error message if generation fails
+	 * @param Options - Serialization options
 	 * @return true if PDF was successfully generated
 	 */
-	static bool GeneratePDFFromJSON(const FString& JsonFilePath, const FString& PdfFilePath, FString& OutErrorMessage);
+	static bool GeneratePDFFromJSON(const FString& JsonFilePath, const FString& PdfFilePath, FString& OutErrorMessage, const FPDFWriteOptions& Options = FPDFWriteOptions());
+
+	/**
+	 * Generate a PDF from JSON configuration data and deliver it to a sink.
+	 * 
+	 * @param JsonFilePath - Full path to the JSON configuration file
+	 * @param Sink - Destination (file, caller-owned memory buffer, socket)
+	 * @param OutErrorMessage - Error message if generation or delivery fails
+	 * @param Options - Serialization options
+	 * @return true if the sink accepted the whole document
+	 */
+	static bool GeneratePDFFromJSON(const FString& JsonFilePath, IPDFOutputSink& Sink, FString& OutErrorMessage, const FPDFWriteOptions& Options = FPDFWriteOptions());
+
+	/**
+	 * Generate a PDF file from configuration data already in memory.
+	 * 
+	 * @param ConfigData - Configuration to render
+	 * @param PdfFilePath - Full path where the PDF should be saved
+	 * @param OutErrorMessage - Error message if generation fails
+	 * @param Options - Serialization options
+	 * @return true if PDF was successfully generated
+	 */
+	static bool GeneratePDF(const FConfigurationData& ConfigData, const FString& PdfFilePath, FString& OutErrorMessage, const FPDFWriteOptions& Options = FPDFWriteOptions());
+
+	/**
+	 * Generate a PDF from configuration data already in memory and deliver it to a sink.
+	 * Use FPDFMemorySink to get the document as a TArray<uint8> without touching disk.
+	 * 
+	 * @param ConfigData - Configuration to render
+	 * @param Sink - Destination (file, caller-owned memory buffer, socket)
+	 * @param OutErrorMessage - Error message if generation or delivery fails
+	 * @param Options - Serialization options
+	 * @return true if the sink accepted the whole document
+	 */
+	static bool GeneratePDF(const FConfigurationData& ConfigData, IPDFOutputSink& Sink, FString& OutErrorMessage, const FPDFWriteOptions& Options = FPDFWriteOptions());
+
+	/**
+	 * Add the configuration to an existing PDF as a new revision (PDF incremental update).
+	 * Only objects that differ from the latest revision are appended, followed by a new xref
+	 * section and a trailer with /Prev; earlier revisions are never modified, and only the
+	 * tail of the file is read (see FPDFIncrementalUpdate). A partial revision left after the
+	 * last %%EOF by an interrupted append is removed first, and a failed append is truncated
+	 * away. Writes a new file if PdfFilePath does not exist yet. Options.bLinearize is ignored,
+	 * because a linearized file cannot be updated in place.
+	 * 
+	 * @param ConfigData - Configuration to render
+	 * @param PdfFilePath - PDF to update (or create)
+	 * @param OutNumObjectsWritten - Objects written in the new revision (0 if nothing changed)
+	 * @param OutErrorMessage - Error message if the file could not be read or written
+	 * @param Options - Serialization options
+	 * @return true if the file now shows the configuration
+	 */
+	static bool AppendPDFRevision(const FConfigurationData& ConfigData, const FString& PdfFilePath, int32& OutNumObjectsWritten, FString& OutErrorMessage, const FPDFWriteOptions& Options = FPDFWriteOptions());
+
+	/**
+	 * Render many configuration JSON files into one catalog PDF (see FPDFCatalogWriter).
+	 * Files are read one at a time and each configuration's pages are written as soon as
+	 * they are laid out, so memory does not grow with the number of files. Files that
+	 * cannot be read are logged and left out.
+	 * 
+	 * @param JsonFilePaths - Configuration files, in the order they should appear
+	 * @param PdfFilePath - Full path where the catalog should be saved
+	 * @param OutNumConfigurations - Number of configurations in the catalog
+	 * @param OutErrorMessage - Error message if generation fails
+	 * @param Options - Serialization options (bLinearize is ignored)
+	 * @return true if the catalog was written
+	 */
+	static bool GenerateCatalogFromJSON(const TArray<FString>& JsonFilePaths, const FString& PdfFilePath, int32& OutNumConfigurations, FString& OutErrorMessage, const FPDFWriteOptions& Options = FPDFWriteOptions());
+
+	/**
+	 * Load a configuration JSON file written by ExportConfigurationToJSON.
+	 * 
+	 * @param JsonFilePath - Full path to the JSON configuration file
+	 * @param OutConfigData - Parsed configuration
+	 * @param OutErrorMessage - Error message if the file is missing or invalid
+	 * @return true if the file was parsed
+	 */
+	static bool LoadConfigurationFromJSON(const FString& JsonFilePath, FConfigurationData& OutConfigData, FString& OutErrorMessage);
+
+	/**
+	 * Build the complete PDF (objects, xref table, trailer) for one configuration.
+	 * Page content streams are serialized (and compressed) in parallel into independent
+	 * buffers, then stitched together in one sequential pass that records the object
+	 * offsets. The result is byte-identical whatever the thread count.
+	 */
+	static TArray<uint8> BuildPDFDocument(const FConfigurationData& ConfigData, const FPDFLayoutProgram& Layout, const FPDFWriteOptions& Options = FPDFWriteOptions());
+
+	/**
+	 * Lay out a configuration and build its object graph without serializing it.
+	 */
+	static void BuildDocument(const FConfigurationData& ConfigData, const FPDFLayoutProgram& Layout, const FPDFWriteOptions& Options, FPDFDocument& OutDocument);
+
+	/**
+	 * Serialize the content stream of every page, using up to Options.MaxThreads workers.
+	 *
+	 * @param OutPageStreams - One finished (optionally compressed) stream per page
+	 */
+	static void SerializePages(
+		const FConfigurationData& ConfigData,
+		const FPDFLayoutProgram& Layout,
+		const TArray<FPDFLayoutPage>& Pages,
+		const FPDFDocumentImages& Images,
+		const FPDFWriteOptions& Options,
+		TArray<FPDFPageStream>& OutPageStreams);
 
-private:
 	/**
-	 * Escape special characters for PDF text content.
-	 * Handles backslashes, parentheses which have special meaning in PDF.
+	 * Load the images referenced by a configuration through FPDFImageCache.
+	 * Relative paths are resolved against the project Content directory. Images that
+	 * fail to load are logged and left out; files with identical contents share one resource.
 	 */
-	static FString EscapePDFString(const FString& Input);
+	static void ResolveImages(const FConfigurationData& ConfigData, const FPDFLayoutProgram& Layout, FPDFDocumentImages& OutImages);
 
 	/**
-	 * Build the PDF content stream (text and positioning commands).
+	 * Build the object graph (catalog, page tree, shared resources, pages) for serialized pages.
+	 * Page streams are moved into the document; embedded fonts are subset to the glyphs the pages draw.
 	 */
-	static FString BuildPDFContentStream(
-		const FString& ConfigName,
-		const FString& Timestamp,
-		const TArray<FString>& Variants,
-		const FString& Environment,
-		const FString& Camera);
+	static void BuildDocumentModel(const FPDFLayoutProgram& Layout, const FPDFDocumentImages& Images, TArray<FPDFPageStream>&& PageStreams, FPDFDocument& OutDocument);
 
 	/**
-	 * Build the complete PDF structure (objects, xref table, trailer).
+	 * Flate-compress a stream in place.
+	 * @return false (stream untouched) if compression failed
 	 */
-	static TArray<uint8> BuildPDFDocument(const FString& ContentStream);
+	static bool CompressStream(TArray<uint8>& InOutStream);
 };
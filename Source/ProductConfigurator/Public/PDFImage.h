@@ -0,0 +1,78 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * An image encoded for embedding as a PDF image XObject.
+ */
+struct PRODUCTCONFIGURATOR_API FPDFImage
+{
+	/** Size in pixels */
+	int32 Width = 0;
+	int32 Height = 0;
+
+	/** DeviceGray, DeviceRGB or DeviceCMYK */
+	FString ColorSpace;
+
+	/** DCTDecode (JPEG file passed through untouched) or FlateDecode */
+	FString Filter;
+
+	/** Adobe CMYK JPEGs store inverted component values */
+	bool bInvertedCMYK = false;
+
+	/** Encoded pixel data, ready to be written as the stream */
+	TArray<uint8> Data;
+
+	/** Flate-encoded 8-bit alpha channel, empty when the image is opaque */
+	TArray<uint8> AlphaData;
+
+	/** Stream dictionary entries describing Data (everything except /Length and /SMask) */
+	FString GetStreamEntries() const;
+
+	/** Stream dictionary entries describing AlphaData */
+	FString GetAlphaStreamEntries() const;
+};
+
+/**
+ * Process-wide cache of encoded images, keyed by a hash of the file contents.
+ * Files are re-read on every export so edits are picked up, but each distinct
+ * image is only decoded and encoded once. Identical files under different
+ * paths share one entry, so they become a single XObject in a document.
+ */
+class PRODUCTCONFIGURATOR_API FPDFImageCache
+{
+public:
+	/**
+	 * Load an image file (JPEG, PNG or any other format ImageWrapper decodes).
+	 *
+	 * @param FilePath - Full path to the image
+	 * @param OutErrorMessage - Error message if the file is missing or cannot be decoded
+	 * @return The encoded image, or null on error
+	 */
+	static TSharedPtr<const FPDFImage> Load(const FString& FilePath, FString& OutErrorMessage);
+
+	/**
+	 * Encode image file contents without going through the cache.
+	 * Baseline and progressive JPEGs are passed through with DCTDecode; everything
+	 * else is decoded and Flate-compressed.
+	 */
+	static TSharedPtr<FPDFImage> Encode(const TArray<uint8>& FileBytes, FString& OutErrorMessage);
+
+	/**
+	 * Read the frame header of a JPEG file.
+	 *
+	 * @param OutComponents - 1 (gray), 3 (YCbCr/RGB) or 4 (CMYK)
+	 * @param bOutAdobe - File has an Adobe APP14 marker (CMYK data is inverted)
+	 * @param bOutPassthrough - File can be embedded as-is (8-bit Huffman coded, baseline or progressive)
+	 * @return false if the data is not a JPEG or has no frame header
+	 */
+	static bool ReadJPEGInfo(const uint8* Data, int64 Num, int32& OutWidth, int32& OutHeight, int32& OutComponents, bool& bOutAdobe, bool& bOutPassthrough);
+
+	/** Drop every cached image */
+	static void Empty();
+
+	/** Encoded bytes kept in the cache before the oldest entries are evicted */
+	static constexpr int64 MaxCachedBytes = 64 * 1024 * 1024;
+};
@@ -0,0 +1,70 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FPDFDocument;
+
+/**
+ * Builds PDF incremental updates (PDF 1.4, section 3.4.5).
+ *
+ * An update is appended to an existing file and contains only the objects that
+ * differ from the latest revision, a cross-reference section for them and a
+ * trailer whose /Prev points at the previous section. Earlier revisions stay
+ * byte-for-byte intact, so the file keeps its full history.
+ *
+ * Objects are matched across revisions by FPDFDocument::FObject::Key. Every revision
+ * ends with a small manifest stream (referenced from the trailer as /RevisionManifest)
+ * listing the number and a hash of each keyed object, so building an update reads
+ * only the newest xref section and that manifest, never the earlier revisions.
+ */
+class PRODUCTCONFIGURATOR_API FPDFIncrementalUpdate
+{
+public:
+	/** Read Num bytes at Offset of the existing file into OutBytes */
+	using FReadRange = TFunctionRef<bool(int64 Offset, int64 Num, TArray<uint8>& OutBytes)>;
+
+	/**
+	 * Build the bytes to append to an existing file so it shows Document.
+	 *
+	 * An object keeps the number its key had in the previous revision and is written only
+	 * if its serialized bytes hash differently; objects with new keys get new numbers.
+	 * Objects the new revision no longer uses are left in place rather than freed, and
+	 * their numbers stay reserved for their keys. A file without a manifest (written some
+	 * other way) gets the whole document appended once under fresh numbers.
+	 *
+	 * @param ExistingSize - Length of the existing file; 0 builds a complete new file
+	 * @param ReadExisting - Reads from the existing file (only its tail is read)
+	 * @param Document - New revision
+	 * @param OutUpdate - Bytes to append (empty if nothing changed)
+	 * @param OutNumChangedObjects - Number of document objects written to the update
+	 * @param OutErrorMessage - Error message if the existing file cannot be read
+	 * @return true if the update was built (or nothing changed)
+	 */
+	static bool Build(int64 ExistingSize, FReadRange ReadExisting, const FPDFDocument& Document, TArray<uint8>& OutUpdate, int32& OutNumChangedObjects, FString& OutErrorMessage);
+
+	/** Build an update for a file held in memory */
+	static bool Build(const TArray<uint8>& ExistingBytes, const FPDFDocument& Document, TArray<uint8>& OutUpdate, int32& OutNumChangedObjects, FString& OutErrorMessage);
+
+	/**
+	 * Length of a file up to the end of its last complete revision: just past the last
+	 * %%EOF marker that follows a "startxref" pointing at an xref section, and its end of
+	 * line. An append that was cut short leaves bytes after that point (which may contain
+	 * stray %%EOF bytes inside stream data); truncate them away before appending the next revision.
+	 *
+	 * @return The length, or INDEX_NONE if the file has no complete revision
+	 */
+	static int64 FindCompleteLength(int64 ExistingSize, FReadRange ReadExisting);
+
+	/**
+	 * Read the cross-reference chain of a file, newest section first.
+	 *
+	 * @param OutObjectOffsets - Offset of the latest revision of every in-use object
+	 * @param OutLastXrefOffset - Offset of the newest xref section (the /Prev of a new update)
+	 * @param OutSize - /Size of the newest trailer
+	 * @param OutNumSections - Number of xref sections in the chain (one per revision, two for a linearized file)
+	 * @return false if the file has no readable cross-reference table
+	 */
+	static bool ReadXrefChain(const TArray<uint8>& Bytes, TMap<int64, int64>& OutObjectOffsets, int64& OutLastXrefOffset, int64& OutSize, int32& OutNumSections, FString& OutErrorMessage);
+};
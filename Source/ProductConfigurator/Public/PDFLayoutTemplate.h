@@ -0,0 +1,218 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FConfigurationData;
+class FPDFTrueTypeFont;
+class FStrProperty;
+class FArrayProperty;
+
+/** What a compiled layout instruction draws */
+enum class EPDFLayoutOp : uint8
+{
+	/** One line of text */
+	Text,
+	/** One line per element of a string array, with an optional "... and N more" line */
+	List,
+	/** One image whose file path is a string field */
+	Image,
+	/** Rows of equally sized images whose file paths are a string array */
+	ImageRow
+};
+
+/** Piece of a text template, resolved per export */
+enum class EPDFLayoutToken : uint8
+{
+	/** Pre-encoded bytes from the literal pool */
+	Literal,
+	/** String property of FConfigurationData */
+	Field,
+	/** 1-based index of the current list item */
+	ItemNumber,
+	/** Value of the current list item */
+	ItemValue,
+	/** Number of list items not shown because of MaxItems */
+	Remaining
+};
+
+struct FPDFLayoutSegment
+{
+	EPDFLayoutToken Token = EPDFLayoutToken::Literal;
+	int32 LiteralStart = 0;
+	int32 LiteralLength = 0;
+	const FStrProperty* Field = nullptr;
+};
+
+struct FPDFLayoutInstruction
+{
+	EPDFLayoutOp Op = EPDFLayoutOp::Text;
+
+	/** Font and size, resolved at compile time (sections inherit from the previous one) */
+	int32 FontIndex = 0;
+	float FontSize = 10.0f;
+
+	/** Horizontal position and vertical gap above the first line */
+	float X = 0.0f;
+	float SpaceBefore = 0.0f;
+
+	/** Text template (or list item template) */
+	int32 FirstSegment = 0;
+	int32 NumSegments = 0;
+
+	/** Glyphs of the template's literal text (embedded fonts only), recorded once per page that draws it */
+	TArray<uint16> LiteralGlyphs;
+
+	/** Section is skipped when this field is empty */
+	const FStrProperty* SkipIfEmpty = nullptr;
+
+	/** List settings */
+	const FArrayProperty* ListField = nullptr;
+	float LineSpacing = 0.0f;
+	int32 MaxItems = 0;
+	int32 FirstMoreSegment = 0;
+	int32 NumMoreSegments = 0;
+	TArray<uint16> MoreLiteralGlyphs;
+
+	/** Image settings (ImageRow reads its paths from ListField) */
+	const FStrProperty* ImageField = nullptr;
+	float ImageWidth = 0.0f;
+	float ImageHeight = 0.0f;
+	float ImageGap = 0.0f;
+	int32 ImagesPerRow = 1;
+};
+
+struct FPDFLayoutFont
+{
+	/** Resource name used in content streams (e.g. F1) */
+	FString ResourceName;
+
+	/** Standard 14 font name (e.g. Helvetica-Bold); empty for embedded fonts */
+	FString BaseFont;
+
+	/** Embedded font (null for standard fonts); its text is written as hex glyph ids and subset per document */
+	TSharedPtr<const FPDFTrueTypeFont> TrueType;
+};
+
+/** Glyphs drawn with each font, collected while serializing pages so embedded fonts can be subset */
+struct FPDFGlyphUsage
+{
+	/** Glyph ids per font, indexed like FPDFLayoutProgram::GetFonts (always empty for standard fonts) */
+	TArray<TSet<uint16>> Fonts;
+
+	void Append(const FPDFGlyphUsage& Other);
+};
+
+/** An image XObject available to a document, looked up by the file path in the configuration */
+struct FPDFLayoutImage
+{
+	/** Resource name used in content streams (e.g. Im1) */
+	FString ResourceName;
+
+	/** Size in pixels, used to keep the aspect ratio */
+	int32 Width = 0;
+	int32 Height = 0;
+};
+
+/** One line (or row of images) placed on a page by FPDFLayoutProgram::Paginate */
+struct FPDFLayoutPlacement
+{
+	/** Item index used for the "... and N more" line of a list */
+	static constexpr int32 MoreLine = -2;
+
+	int32 Instruction = 0;
+
+	/** INDEX_NONE for text, list index for list items (first image of the row for image rows), or MoreLine */
+	int32 Item = INDEX_NONE;
+
+	/** Baseline position from the bottom of the page (bottom edge for images) */
+	float Y = 0.0f;
+};
+
+struct FPDFLayoutPage
+{
+	TArray<FPDFLayoutPlacement> Placements;
+};
+
+/**
+ * A PDF layout template compiled into a flat instruction list.
+ *
+ * Templates are JSON (see Content/ProductConfig/Layouts/PDFLayout.json) describing
+ * the page, the fonts and a list of sections bound to FConfigurationData fields.
+ * All parsing, name lookups and literal escaping happen in Compile; exporting a
+ * document only walks the instructions.
+ */
+class PRODUCTCONFIGURATOR_API FPDFLayoutProgram
+{
+public:
+	/**
+	 * Compile a JSON layout template.
+	 *
+	 * @param TemplateJson - Template source
+	 * @param OutErrorMessage - Error message if the template is invalid
+	 * @param OutFontFiles - Optionally receives the full paths of the font files the template
+	 *                       names, also when compiling fails (e.g. because one is missing)
+	 * @return The compiled program, or null on error
+	 */
+	static TSharedPtr<const FPDFLayoutProgram> Compile(const FString& TemplateJson, FString& OutErrorMessage, TArray<FString>* OutFontFiles = nullptr);
+
+	/**
+	 * Decide which lines go on which page. Starts a new page whenever the
+	 * next line would fall below the bottom margin.
+	 */
+	void Paginate(const FConfigurationData& Data, TArray<FPDFLayoutPage>& OutPages) const;
+
+	/**
+	 * Collect the image file paths referenced by the image sections, in order of first use.
+	 */
+	void CollectImagePaths(const FConfigurationData& Data, TArray<FString>& OutPaths) const;
+
+	/**
+	 * Append the content stream (text, positioning and image drawing commands) of one page.
+	 *
+	 * @param Images - Images available to the document by file path; paths not found are left blank
+	 * @param OutGlyphs - Glyphs drawn with embedded fonts are added here
+	 */
+	void SerializePage(const FConfigurationData& Data, const FPDFLayoutPage& Page, const TMap<FString, FPDFLayoutImage>& Images, TArray<uint8>& OutStream, FPDFGlyphUsage& OutGlyphs) const;
+
+	float GetPageWidth() const { return PageWidth; }
+	float GetPageHeight() const { return PageHeight; }
+	const TArray<FPDFLayoutFont>& GetFonts() const { return Fonts; }
+
+private:
+	void AppendSegments(const FConfigurationData& Data, const FPDFLayoutInstruction& Instruction, int32 FirstSegment, int32 NumSegments, int32 Item, TArray<uint8>& OutStream, FPDFGlyphUsage& OutGlyphs) const;
+	bool CompileText(const FString& Text, const FPDFLayoutFont& Font, bool bAllowListTokens, int32& OutFirstSegment, int32& OutNumSegments, TArray<uint16>& OutLiteralGlyphs, FString& OutErrorMessage);
+
+	float PageWidth = 612.0f;
+	float PageHeight = 792.0f;
+	float Top = 750.0f;
+	float Bottom = 50.0f;
+
+	TArray<FPDFLayoutFont> Fonts;
+	TArray<FPDFLayoutInstruction> Instructions;
+	TArray<FPDFLayoutSegment> Segments;
+
+	/** Bytes of every literal segment: escaped UTF-8, or hex glyph ids for embedded fonts */
+	TArray<uint8> LiteralPool;
+};
+
+/**
+ * Process-wide cache of the compiled layout template.
+ * The template file is compiled on first use and recompiled whenever its timestamp
+ * or that of a font file it names changes, so edits and replaced fonts show up in
+ * the next export without a restart.
+ * Falls back to a minimal built-in layout (text only) if the file is missing or invalid.
+ */
+class PRODUCTCONFIGURATOR_API FPDFLayoutTemplateCache
+{
+public:
+	/** Compiled program for the current template file */
+	static TSharedRef<const FPDFLayoutProgram> Get();
+
+	/** Minimal built-in layout used when no valid template file exists */
+	static TSharedRef<const FPDFLayoutProgram> GetDefault();
+
+	/** Full path of the template file */
+	static FString GetTemplatePath();
+};
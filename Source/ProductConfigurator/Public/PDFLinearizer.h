@@ -0,0 +1,35 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FPDFDocument;
+
+/**
+ * Writes linearized ("Fast Web View") PDF files (PDF 1.4, Annex F).
+ *
+ * File order: header, linearization dictionary, first-page xref and trailer,
+ * catalog, primary hint stream, first page with the shared objects it uses,
+ * remaining pages, other objects, main xref. A viewer can draw page one as
+ * soon as the first /E bytes have arrived.
+ */
+class PRODUCTCONFIGURATOR_API FPDFLinearizer
+{
+public:
+	/**
+	 * Serialize a document in linearized form.
+	 * The document must have a catalog and at least one page with a content stream.
+	 */
+	static void Write(const FPDFDocument& Document, TArray<uint8>& OutBytes);
+
+	/**
+	 * Check the linearization dictionary, both xref sections and the hint stream
+	 * header of a file against its actual bytes.
+	 *
+	 * @param Bytes - Complete PDF file
+	 * @param OutErrorMessage - First mismatch found
+	 * @return true if the file is consistently linearized
+	 */
+	static bool Validate(const TArray<uint8>& Bytes, FString& OutErrorMessage);
+};
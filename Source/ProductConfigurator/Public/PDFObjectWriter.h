@@ -0,0 +1,76 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Low-level PDF serializer.
+ * Appends numbered objects to a byte buffer, remembers where each one starts
+ * and writes a matching cross-reference table and trailer.
+ */
+class PRODUCTCONFIGURATOR_API FPDFObjectWriter
+{
+public:
+	explicit FPDFObjectWriter(TArray<uint8>& InOutput);
+
+	/** Write the %PDF header plus a binary marker comment */
+	void WriteHeader();
+
+	/** Append raw text (converted to UTF-8) */
+	void Write(const FString& Text);
+
+	/** Append raw ASCII text */
+	void Write(const ANSICHAR* Text);
+
+	/** Append raw bytes */
+	void Write(const uint8* Data, int64 Num);
+
+	/** Start "N 0 obj" and record its offset */
+	void BeginObject(int32 ObjectNumber);
+
+	/** Close the current object */
+	void EndObject();
+
+	/** Write a complete object whose body is a single dictionary or value */
+	void WriteObject(int32 ObjectNumber, const FString& Body);
+
+	/**
+	 * Write a complete stream object.
+	 * @param ExtraEntries - Additional dictionary entries (e.g. "/Filter /FlateDecode"); /Length is added automatically
+	 */
+	void WriteStreamObject(int32 ObjectNumber, const FString& ExtraEntries, const uint8* Data, int64 Num);
+
+	/**
+	 * Append a complete object record to a buffer without recording its offset.
+	 * WriteObject and FPDFDocument::SerializeObject both format objects through here,
+	 * so an object serialized on its own is byte-identical to the same object in a written file.
+	 */
+	static void AppendObject(TArray<uint8>& Out, int32 ObjectNumber, const FString& Body);
+
+	/** Append a complete stream object record to a buffer without recording its offset (see AppendObject) */
+	static void AppendStreamObject(TArray<uint8>& Out, int32 ObjectNumber, const FString& ExtraEntries, const uint8* Data, int64 Num);
+
+	/** Write the xref table covering objects 0..max, the trailer and startxref */
+	void WriteXrefAndTrailer(int32 RootObjectNumber);
+
+	/** Current write offset in bytes, counted from the start of the file */
+	int64 Tell() const { return NumBytesReleased + Output.Num(); }
+
+	/**
+	 * Empty the output buffer once the caller has stored its contents (e.g. written them to disk).
+	 * Offsets keep counting from the start of the file, so a long document can be written in pieces.
+	 */
+	void ReleaseOutput();
+
+private:
+	void RecordOffset(int32 ObjectNumber);
+
+	TArray<uint8>& Output;
+
+	/** Bytes handed out by ReleaseOutput */
+	int64 NumBytesReleased = 0;
+
+	/** Offset of each object by object number (INDEX_NONE for unused numbers) */
+	TArray<int64> ObjectOffsets;
+};
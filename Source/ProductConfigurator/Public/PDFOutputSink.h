@@ -0,0 +1,79 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Destination of a finished PDF document.
+ * FPDFGenerator builds the whole file in memory (offsets in the xref table and,
+ * for linearized files, in the header depend on every byte) and hands it to a
+ * sink in one call.
+ */
+class PRODUCTCONFIGURATOR_API IPDFOutputSink
+{
+public:
+	virtual ~IPDFOutputSink() = default;
+
+	/**
+	 * Deliver a complete document.
+	 *
+	 * @param Bytes - PDF file contents; the sink may take ownership of the buffer
+	 * @param OutErrorMessage - Error message if the document could not be delivered
+	 * @return true if the sink accepted every byte
+	 */
+	virtual bool Write(TArray<uint8>&& Bytes, FString& OutErrorMessage) = 0;
+
+	/** Destination shown in log messages (file path, "memory", address) */
+	virtual FString Describe() const = 0;
+};
+
+/**
+ * Writes the document to a file, creating the directory if needed.
+ * The file is replaced atomically (see FAtomicFileWriter).
+ */
+class PRODUCTCONFIGURATOR_API FPDFFileSink : public IPDFOutputSink
+{
+public:
+	explicit FPDFFileSink(const FString& InFilePath);
+
+	virtual bool Write(TArray<uint8>&& Bytes, FString& OutErrorMessage) override;
+	virtual FString Describe() const override { return FilePath; }
+
+private:
+	FString FilePath;
+};
+
+/**
+ * Hands the document to a caller-owned buffer.
+ * The generator's buffer is moved into it, so the bytes are never copied.
+ */
+class PRODUCTCONFIGURATOR_API FPDFMemorySink : public IPDFOutputSink
+{
+public:
+	explicit FPDFMemorySink(TArray<uint8>& InOutBuffer);
+
+	virtual bool Write(TArray<uint8>&& Bytes, FString& OutErrorMessage) override;
+	virtual FString Describe() const override { return TEXT("memory"); }
+
+private:
+	TArray<uint8>& Buffer;
+};
+
+/**
+ * Streams the document to a local TCP listener (e.g. an upload daemon).
+ * Connects to the loopback address, sends every byte and half-closes the connection,
+ * so the receiver reads until end of stream. The connection is closed once the receiver
+ * closes its side (or after a short timeout), so the end of the document is not lost to a reset.
+ */
+class PRODUCTCONFIGURATOR_API FPDFSocketSink : public IPDFOutputSink
+{
+public:
+	explicit FPDFSocketSink(int32 InPort);
+
+	virtual bool Write(TArray<uint8>&& Bytes, FString& OutErrorMessage) override;
+	virtual FString Describe() const override;
+
+private:
+	int32 Port = 0;
+};
@@ -0,0 +1,55 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ULevelVariantSets;
+class ALevelVariantSetsActor;
+
+/**
+ * Helpers for reading and restoring the selected variant of every VariantSet.
+ * A selection is one index per VariantSet, in set order, with INDEX_NONE for
+ * sets that have no active variant.
+ */
+class PRODUCTCONFIGURATOR_API FVariantSelection
+{
+public:
+	/**
+	 * Capture the currently active variant index of every VariantSet.
+	 *
+	 * @param VariantSets - The LevelVariantSets asset to read
+	 * @param OutSelection - One variant index per set (INDEX_NONE if nothing is active)
+	 * @return true if the asset was valid
+	 */
+	static bool CaptureSelection(ULevelVariantSets* VariantSets, TArray<int32>& OutSelection);
+
+	/**
+	 * Switch the level to a selection, touching only the sets that differ.
+	 * Sets whose target variant is already active in the level (or whose entry is INDEX_NONE)
+	 * are skipped; the others are validated first, then switched on one by one.
+	 *
+	 * Only the target variant of each set is compared against the level, so variants
+	 * switched any other way (Blueprint, the Variant Manager) are always seen.
+	 *
+	 * @param LevelVariantSetsActor - The actor owning the LevelVariantSets asset
+	 * @param Selection - One variant index per set
+	 * @param OutNumSwitched - Number of sets whose variant was switched
+	 * @param OutErrorMessage - Error message if the selection does not match the asset
+	 * @return true if the selection was applied
+	 */
+	static bool ApplySelection(ALevelVariantSetsActor* LevelVariantSetsActor, const TArray<int32>& Selection, int32& OutNumSwitched, FString& OutErrorMessage);
+
+	/**
+	 * Resolve "VariantSet: Variant" lines (as stored in FConfigurationData::SelectedVariants)
+	 * back into a selection. Sets that are not mentioned, or listed as "None", map to INDEX_NONE.
+	 *
+	 * @return false if a line names a set or variant that does not exist in the asset
+	 */
+	static bool ResolveSelection(ULevelVariantSets* VariantSets, const TArray<FString>& Lines, TArray<int32>& OutSelection, FString& OutErrorMessage);
+
+	/**
+	 * Build the "VariantSet: Variant" lines used by FConfigurationData::SelectedVariants.
+	 */
+	static void DescribeSelection(ULevelVariantSets* VariantSets, const TArray<int32>& Selection, TArray<FString>& OutLines);
+};